@@ -0,0 +1,223 @@
+/**
+ * @file bench_compare.c
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 R. D. Poor <rdpoor # gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Compare two result files written by bench_mu_json.
+
+Usage:
+
+  bench_compare baseline.csv candidate.csv
+
+For each benchmark found in both files, prints the median throughput (MB/s)
+and the median absolute deviation (MAD) of each run, the change in median,
+and whether the change is statistically significant according to a two-sided
+Mann-Whitney U test at the 5% level.  Exits with status 2 if any benchmark is
+significantly slower in the candidate run.
+*/
+
+// *****************************************************************************
+// Includes
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// *****************************************************************************
+// Private types and definitions
+
+#define MAX_BENCHMARKS 64
+#define MAX_TRIALS 256
+#define MAX_NAME 64
+#define MAX_LINE 256
+#define Z_CRITICAL 1.96 // two-sided, 5% significance
+
+typedef struct {
+    char name[MAX_NAME];
+    int n;                      // number of trials
+    double mbps[MAX_TRIALS];    // throughput of each trial, MB/s
+} series_t;
+
+typedef struct {
+    int n_series;
+    series_t series[MAX_BENCHMARKS];
+} results_t;
+
+// *****************************************************************************
+// Private (static) storage
+
+static results_t s_baseline;
+static results_t s_candidate;
+
+// *****************************************************************************
+// Private (forward) declarations
+
+static bool read_results(const char *filename, results_t *results);
+static series_t *find_series(results_t *results, const char *name);
+static int compare_doubles(const void *a, const void *b);
+static double median(const double *values, int n);
+static double mad(const double *values, int n, double med);
+static double mann_whitney_z(const series_t *a, const series_t *b);
+
+// *****************************************************************************
+// Public code
+
+int main(int argc, char **argv) {
+    bool regressed = false;
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s baseline.csv candidate.csv\n", argv[0]);
+        return 1;
+    }
+    if (!read_results(argv[1], &s_baseline) ||
+        !read_results(argv[2], &s_candidate)) {
+        return 1;
+    }
+
+    printf("%-22s %12s %8s %12s %8s %8s %6s  %s\n", "benchmark", "base MB/s",
+           "MAD", "cand MB/s", "MAD", "change", "z", "verdict");
+    for (int i = 0; i < s_baseline.n_series; i++) {
+        series_t *a = &s_baseline.series[i];
+        series_t *b = find_series(&s_candidate, a->name);
+        if (b == NULL) {
+            printf("%-22s (missing from %s)\n", a->name, argv[2]);
+            continue;
+        }
+        double med_a = median(a->mbps, a->n);
+        double med_b = median(b->mbps, b->n);
+        double z = mann_whitney_z(a, b);
+        const char *verdict = "~";
+        if (fabs(z) >= Z_CRITICAL) {
+            // z > 0 means candidate throughputs rank higher
+            verdict = z > 0 ? "faster" : "SLOWER";
+            regressed |= z < 0;
+        }
+        printf("%-22s %12.1f %8.1f %12.1f %8.1f %+7.1f%% %6.2f  %s\n",
+               a->name, med_a, mad(a->mbps, a->n, med_a), med_b,
+               mad(b->mbps, b->n, med_b), 100.0 * (med_b - med_a) / med_a, z,
+               verdict);
+    }
+    return regressed ? 2 : 0;
+}
+
+// *****************************************************************************
+// Private (static) code
+
+static bool read_results(const char *filename, results_t *results) {
+    char line[MAX_LINE];
+    char name[MAX_NAME];
+    int trial;
+    unsigned long long bytes, ns;
+
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "could not open %s\n", filename);
+        return false;
+    }
+    results->n_series = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (sscanf(line, "%63[^,],%d,%llu,%llu", name, &trial, &bytes, &ns) !=
+                4 ||
+            ns == 0) {
+            // header or malformed line
+            continue;
+        }
+        series_t *series = find_series(results, name);
+        if (series == NULL) {
+            if (results->n_series == MAX_BENCHMARKS) {
+                continue;
+            }
+            series = &results->series[results->n_series++];
+            snprintf(series->name, sizeof(series->name), "%s", name);
+            series->n = 0;
+        }
+        if (series->n < MAX_TRIALS) {
+            // bytes per nanosecond * 1000 = MB/s
+            series->mbps[series->n++] = 1000.0 * (double)bytes / (double)ns;
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+static series_t *find_series(results_t *results, const char *name) {
+    for (int i = 0; i < results->n_series; i++) {
+        if (strcmp(results->series[i].name, name) == 0) {
+            return &results->series[i];
+        }
+    }
+    return NULL;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static double median(const double *values, int n) {
+    double sorted[MAX_TRIALS];
+    memcpy(sorted, values, n * sizeof(double));
+    qsort(sorted, n, sizeof(double), compare_doubles);
+    if (n == 0) {
+        return 0.0;
+    } else if (n & 1) {
+        return sorted[n / 2];
+    } else {
+        return (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+    }
+}
+
+static double mad(const double *values, int n, double med) {
+    double deviations[MAX_TRIALS];
+    for (int i = 0; i < n; i++) {
+        deviations[i] = fabs(values[i] - med);
+    }
+    return median(deviations, n);
+}
+
+static double mann_whitney_z(const series_t *a, const series_t *b) {
+    // U statistic for b: number of (a, b) pairs where b ranks above a, ties
+    // counting one half.  Under the null hypothesis U is approximately normal.
+    double u = 0.0;
+    for (int i = 0; i < a->n; i++) {
+        for (int j = 0; j < b->n; j++) {
+            if (b->mbps[j] > a->mbps[i]) {
+                u += 1.0;
+            } else if (b->mbps[j] == a->mbps[i]) {
+                u += 0.5;
+            }
+        }
+    }
+    double n1 = a->n;
+    double n2 = b->n;
+    double sigma = sqrt(n1 * n2 * (n1 + n2 + 1) / 12.0);
+    if (sigma == 0.0) {
+        return 0.0;
+    }
+    return (u - n1 * n2 / 2.0) / sigma;
+}
@@ -0,0 +1,619 @@
+/**
+ * @file bench_mu_json.c
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 R. D. Poor <rdpoor # gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Benchmark mu_json and mu_str, writing one CSV row per trial.
+
+Usage:
+
+  bench_mu_json [-n trials] [-o results.csv] [benchmark_name ...]
+
+Each benchmark is calibrated to run for at least MIN_TRIAL_NS per trial, then
+timed for `trials` trials.  The output has the header:
+
+  benchmark,trial,bytes,ns
+
+where `bytes` is the number of input bytes processed in the trial and `ns` is
+the elapsed wall-clock time in nanoseconds.  Use bench_compare to compare two
+result files.
+*/
+
+// *****************************************************************************
+// Includes
+
+#include "mu_json.h"
+#include "mu_json_batch.h"
+#include "mu_str.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// *****************************************************************************
+// Private types and definitions
+
+#define DEFAULT_TRIALS 15
+#define MIN_TRIAL_NS 20000000ULL // 20 mSec per trial
+#define MAX_JSON_STRING 1000000
+#define MAX_TOKENS 200000
+#define N_MESSAGES 512
+#define MESSAGE_TOKENS (MAX_TOKENS / N_MESSAGES)
+#define N_THREADS 4 // threads for the parallel phases of a chunked parse
+
+typedef struct {
+    const char *name;
+    size_t (*setup)(void); // generate input, return bytes processed per rep
+    void (*run)(void);     // process the input once
+} benchmark_t;
+
+// *****************************************************************************
+// Private (static) storage
+
+// allow room for a NUL or MU_JSON_PADDING after the input
+static uint8_t s_json[MAX_JSON_STRING + MU_JSON_PADDING];
+static size_t s_json_len;
+static mu_json_token_t s_tokens[MAX_TOKENS];
+static mu_json_batch_doc_t s_messages[N_MESSAGES]; // slices of s_json
+static int16_t s_depths[MAX_TOKENS]; // struct-of-arrays copy of s_tokens
+static uint8_t s_types[MAX_TOKENS];
+static uint8_t s_flags[MAX_TOKENS];
+static uint32_t s_offsets[MAX_TOKENS];
+static uint32_t s_lengths[MAX_TOKENS];
+static mu_json_value_t s_values[MAX_TOKENS]; // numbers decoded by the parser
+static double s_doubles[MAX_TOKENS];
+static int32_t s_ids[MAX_TOKENS]; // columns of the records
+static mu_str_t s_names[MAX_TOKENS];
+static bool s_oks[MAX_TOKENS];
+static uint8_t s_valid[3][MAX_TOKENS / 8];
+static mu_json_projection_t s_projection;
+static int32_t s_entries[5000]; // one per record
+static mu_json_array_index_t s_array_index;
+static mu_json_filter_t s_filter;
+static mu_json_soa_t s_soa;
+static mu_json_chunked_t s_chunked;
+static mu_json_batch_t s_pool;
+static mu_json_batch_job_t s_pool_jobs[N_MESSAGES];
+static bool s_pool_running;
+static volatile int s_sink; // defeat dead code elimination
+
+// *****************************************************************************
+// Private (forward) declarations
+
+static uint64_t now_ns(void);
+static size_t append(size_t len, const char *cstr);
+
+// *****************************************************************************
+// Benchmarks
+
+static void run_parse(void) {
+    s_sink = mu_json_parse_buffer(s_tokens, MAX_TOKENS, s_json, s_json_len,
+                                  NULL);
+}
+
+static void run_parse_c_str(void) {
+    s_json[s_json_len] = '\0';
+    s_sink = mu_json_parse_c_str(s_tokens, MAX_TOKENS, (const char *)s_json,
+                                 NULL);
+}
+
+static void run_parse_padded(void) {
+    memset(&s_json[s_json_len], 0, MU_JSON_PADDING);
+    s_sink = mu_json_parse_padded(s_tokens, MAX_TOKENS, s_json, s_json_len,
+                                  NULL);
+}
+
+static void run_parse_values(void) {
+    mu_json_parse_opts_t opts = {.values = s_values};
+    s_sink = mu_json_parse_buffer(s_tokens, MAX_TOKENS, s_json, s_json_len,
+                                  &opts);
+}
+
+static void run_parse_sparse(void) {
+    mu_json_parse_opts_t opts = {.sparse_arrays = true};
+    s_sink = mu_json_parse_buffer(s_tokens, MAX_TOKENS, s_json, s_json_len,
+                                  &opts);
+}
+
+static size_t setup_messages(void) {
+    // N_MESSAGES small documents of a few hundred bytes each
+    size_t len = 0;
+    for (int i = 0; i < N_MESSAGES; i++) {
+        size_t start = len;
+        len = append(len, "{\"topic\": \"sensors/7\", \"seq\": 1234, "
+                          "\"data\": [");
+        for (int j = 0; j < 4 + i % 8; j++) {
+            len = append(len, j == 0 ? "" : ", ");
+            len = append(len, "{\"t\": 1.5e3, \"v\": -0.25, \"ok\": true}");
+        }
+        len = append(len, "]}");
+        s_messages[i].buf = &s_json[start];
+        s_messages[i].buflen = len - start;
+        s_messages[i].tokens = &s_tokens[i * MESSAGE_TOKENS];
+        s_messages[i].max_tokens = MESSAGE_TOKENS;
+    }
+    return s_json_len = len;
+}
+
+static void run_messages_sequential(void) {
+    for (int i = 0; i < N_MESSAGES; i++) {
+        mu_json_batch_doc_t *doc = &s_messages[i];
+        doc->result = mu_json_parse_buffer(doc->tokens, doc->max_tokens,
+                                           doc->buf, doc->buflen, NULL);
+    }
+    s_sink = s_messages[0].result;
+}
+
+static void run_messages_batch(void) {
+    s_sink = mu_json_parse_batch(s_messages, N_MESSAGES, NULL);
+}
+
+static void run_parse_chunked(void) {
+    s_sink = mu_json_parse_chunked(s_tokens, MAX_TOKENS, s_json, s_json_len,
+                                   N_THREADS, NULL);
+}
+
+static void *chunked_scan_thread(void *arg) {
+    mu_json_chunked_scan(&s_chunked, (size_t)arg);
+    return NULL;
+}
+
+static void *chunked_parse_thread(void *arg) {
+    mu_json_chunked_parse(&s_chunked, (size_t)arg);
+    return NULL;
+}
+
+static void run_chunked_phase(size_t n_chunks, void *(*phase)(void *)) {
+    pthread_t threads[MU_JSON_MAX_CHUNKS];
+    for (size_t i = 0; i < n_chunks; i++) {
+        pthread_create(&threads[i], NULL, phase, (void *)i);
+    }
+    for (size_t i = 0; i < n_chunks; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+static void run_parse_chunked_threads(void) {
+    size_t n_chunks = mu_json_chunked_init(&s_chunked, s_tokens, MAX_TOKENS,
+                                           s_json, s_json_len, N_THREADS,
+                                           NULL);
+    run_chunked_phase(n_chunks, chunked_scan_thread);
+    run_chunked_phase(mu_json_chunked_plan(&s_chunked), chunked_parse_thread);
+    s_sink = mu_json_chunked_finish(&s_chunked);
+}
+
+// Start a pool of n_workers threads to parse the messages.  The pool is
+// stopped by the next pool benchmark's setup, or at exit.
+static size_t setup_pool(int n_workers) {
+    size_t bytes = setup_messages();
+    if (s_pool_running) {
+        mu_json_batch_deinit(&s_pool);
+    }
+    s_pool_running = mu_json_batch_init(&s_pool, n_workers);
+    for (int i = 0; i < N_MESSAGES; i++) {
+        s_pool_jobs[i].doc = s_messages[i];
+    }
+    return bytes;
+}
+
+static size_t setup_pool_1(void) {
+    return setup_pool(1);
+}
+
+static size_t setup_pool_2(void) {
+    return setup_pool(2);
+}
+
+static size_t setup_pool_4(void) {
+    return setup_pool(4);
+}
+
+static size_t setup_pool_8(void) {
+    return setup_pool(8);
+}
+
+static void run_messages_pool(void) {
+    for (int i = 0; i < N_MESSAGES; i++) {
+        while (!mu_json_batch_submit(&s_pool, &s_pool_jobs[i])) {
+            mu_json_batch_wait(&s_pool);
+        }
+    }
+    mu_json_batch_wait(&s_pool);
+    s_sink = s_pool_jobs[0].doc.result;
+}
+
+static void run_validate(void) {
+    s_sink = mu_json_validate(s_json, s_json_len);
+}
+
+static size_t setup_wide_object(void) {
+    size_t len = append(0, "{");
+    for (int i = 0; i < 20000; i++) {
+        len = append(len, i == 0 ? "\"key\":12345" : ",\"key\":12345");
+    }
+    return s_json_len = append(len, "}");
+}
+
+static size_t setup_wide_array(void) {
+    size_t len = append(0, "[");
+    for (int i = 0; i < 50000; i++) {
+        len = append(len, i == 0 ? "-1.5e3" : ",-1.5e3");
+    }
+    return s_json_len = append(len, "]");
+}
+
+static size_t setup_deep_nesting(void) {
+    size_t len = 0;
+    for (int i = 0; i < 10000; i++) {
+        len = append(len, "{\"a\":[");
+    }
+    len = append(len, "null");
+    for (int i = 0; i < 10000; i++) {
+        len = append(len, "]}");
+    }
+    return s_json_len = len;
+}
+
+static size_t setup_long_string(void) {
+    size_t len = append(0, "\"");
+    for (int i = 0; i < 50000; i++) {
+        len = append(len, "lorem ipsum\\n");
+    }
+    return s_json_len = append(len, "\"");
+}
+
+static size_t setup_records(void) {
+    // an array of small, typical-looking records
+    size_t len = append(0, "[");
+    for (int i = 0; i < 5000; i++) {
+        len = append(len, i == 0 ? "" : ",");
+        len = append(len, "{\"id\": 1234, \"name\": \"sensor\", \"ok\": true, "
+                          "\"v\": [0.25, -1.0e-3, 42], \"tag\": null}");
+    }
+    return s_json_len = append(len, "]");
+}
+
+static size_t setup_records_projection(void) {
+    // two fields out of 5000 records
+    static const char *const pointers[] = {"/0/id", "/4999/name"};
+    mu_json_projection_init(&s_projection, pointers, 2);
+    return setup_records();
+}
+
+static void run_parse_projection(void) {
+    mu_json_parse_opts_t opts = {.projection = &s_projection};
+    s_sink = mu_json_parse_buffer(s_tokens, MAX_TOKENS, s_json, s_json_len,
+                                  &opts);
+}
+
+static size_t setup_log_lines(void) {
+    // NDJSON log lines, one in a hundred an error
+    static const mu_json_filter_predicate_t predicates[] = {
+        {.pointer = "/level",
+         .op = MU_JSON_FILTER_EQUALS,
+         .value = "\"error\""},
+    };
+    size_t len = 0;
+    for (int i = 0; i < 5000; i++) {
+        len = append(len, "{\"ts\": 1700000000, \"level\": ");
+        len = append(len, i % 100 == 0 ? "\"error\"" : "\"info\"");
+        len = append(len, ", \"msg\": \"request served\", \"ms\": 12, "
+                          "\"path\": \"/api/v1/items\"}\n");
+    }
+    mu_json_filter_init(&s_filter, predicates, 1, s_tokens, MAX_TOKENS);
+    return s_json_len = len;
+}
+
+static void run_filter_ndjson(void) {
+    s_sink = mu_json_filter_ndjson(&s_filter, s_json, s_json_len, NULL, NULL);
+}
+
+static void run_filter_ndjson_parse_all(void) {
+    // the same filter without the prefilter: parse every line
+    mu_str_t rest;
+    int n = 0;
+    for (size_t from = 0; from < s_json_len;) {
+        mu_str_init(&rest, &s_json[from], s_json_len - from);
+        size_t nl = mu_str_find_byte(&rest, '\n');
+        size_t end = nl == MU_STR_NOT_FOUND ? s_json_len : from + nl;
+        int n_tokens = mu_json_parse_buffer(s_tokens, MAX_TOKENS,
+                                            &s_json[from], end - from, NULL);
+        if (n_tokens > 0 &&
+            mu_str_compare_cstr(&s_tokens[4].json, "\"error\"") == 0) {
+            n += 1;
+        }
+        from = end + 1;
+    }
+    s_sink = n;
+}
+
+static size_t setup_records_tree(void) {
+    // parse the records once; the benchmarks navigate the result
+    size_t len = setup_records();
+    int n = mu_json_parse_buffer(s_tokens, MAX_TOKENS, s_json, len, NULL);
+    mu_json_soa_init(&s_soa, s_depths, s_types, s_flags, s_offsets,
+                     s_lengths, MAX_TOKENS);
+    mu_json_soa_from_tokens(&s_soa, s_tokens, n);
+    return len;
+}
+
+static void run_siblings(void) {
+    // visit every record: each step skips over the previous record's tokens
+    int n = 0;
+    for (mu_json_token_t *t = mu_json_token_child(s_tokens); t != NULL;
+         t = mu_json_token_next_sibling(t)) {
+        n += 1;
+    }
+    s_sink = n;
+}
+
+static void run_element_walk(void) {
+    // 100 lookups at scattered indexes, each from the first element
+    uint32_t i = 1;
+    int n = 0;
+    for (int k = 0; k < 100; k++) {
+        i = (i * 1103515245u + 12345u) % 5000;
+        mu_json_token_t *t = mu_json_token_child(s_tokens);
+        for (uint32_t j = 0; j < i; j++) {
+            t = mu_json_token_next_sibling(t);
+        }
+        n += t->depth;
+    }
+    s_sink = n;
+}
+
+static void run_element_index(void) {
+    // the same lookups, including building the index on the first one
+    uint32_t i = 1;
+    int n = 0;
+    mu_json_array_index_init(&s_array_index, s_entries, 5000);
+    for (int k = 0; k < 100; k++) {
+        i = (i * 1103515245u + 12345u) % 5000;
+        n += mu_json_array_index_get(&s_array_index, s_tokens, i)->depth;
+    }
+    s_sink = n;
+}
+
+static void run_siblings_soa(void) {
+    int n = 0;
+    for (int i = mu_json_soa_child(&s_soa, 0); i >= 0;
+         i = mu_json_soa_next_sibling(&s_soa, i)) {
+        n += 1;
+    }
+    s_sink = n;
+}
+
+static void run_extract_columns(void) {
+    mu_json_column_t columns[] = {
+        {.key = "id", .type = MU_JSON_COLUMN_INT32, s_ids, s_valid[0]},
+        {.key = "name", .type = MU_JSON_COLUMN_STRING, s_names, s_valid[1]},
+        {.key = "ok", .type = MU_JSON_COLUMN_BOOL, s_oks, s_valid[2]},
+    };
+    mu_json_extractor_t extractor;
+    mu_json_extractor_init(&extractor, columns, 3, MAX_TOKENS);
+    s_sink = mu_json_extract_columns(&extractor, s_tokens);
+}
+
+static void run_find_byte(void) {
+    mu_str_t str;
+    mu_str_init(&str, s_json, s_json_len);
+    s_sink = mu_str_find_byte(&str, '!');
+}
+
+static void run_find_substr(void) {
+    mu_str_t str;
+    mu_str_init(&str, s_json, s_json_len);
+    s_sink = mu_str_find_subcstr(&str, "sensor!");
+}
+
+static void run_parse_int(void) {
+    mu_str_t str;
+    int sum = 0;
+    for (size_t i = 0; i < s_json_len; i += 10) {
+        mu_str_init(&str, &s_json[i], 10);
+        sum += mu_str_parse_int(&str);
+    }
+    s_sink = sum;
+}
+
+static size_t setup_coordinates(void) {
+    // a GeoJSON-style array of longitude, latitude pairs
+    char pair[64];
+    size_t len = append(0, "[");
+    for (int i = 0; i < 20000; i++) {
+        snprintf(pair, sizeof(pair), "%s-122.%07d,37.%07d", i == 0 ? "" : ",",
+                 (i * 7919) % 10000000, (i * 104729) % 10000000);
+        len = append(len, pair);
+    }
+    s_json_len = append(len, "]");
+    mu_json_parse_buffer(s_tokens, MAX_TOKENS, s_json, s_json_len, NULL);
+    return s_json_len;
+}
+
+static void run_coordinates_strtod(void) {
+    // the element-by-element way: one strtod() per sibling
+    char buf[32];
+    int n = 0;
+    for (mu_json_token_t *t = mu_json_token_child(s_tokens); t != NULL;
+         t = mu_json_token_next_sibling(t)) {
+        mu_str_t *slice = mu_json_token_slice(t);
+        snprintf(buf, sizeof(buf), "%.*s", (int)mu_str_length(slice),
+                 mu_str_buf(slice));
+        s_doubles[n++] = strtod(buf, NULL);
+    }
+    s_sink = n;
+}
+
+static void run_coordinates_tokens(void) {
+    s_sink = mu_json_array_to_doubles(s_tokens, s_doubles, MAX_TOKENS);
+}
+
+static void run_coordinates_buffer(void) {
+    s_sink = mu_json_buffer_to_doubles(s_json, s_json_len, s_doubles,
+                                       MAX_TOKENS);
+}
+
+static size_t setup_digits(void) {
+    size_t len = 0;
+    for (int i = 0; i < 50000; i++) {
+        len = append(len, "-123456789");
+    }
+    return s_json_len = len;
+}
+
+static const benchmark_t s_benchmarks[] = {
+    {"parse_wide_object", setup_wide_object, run_parse},
+    {"parse_wide_array", setup_wide_array, run_parse},
+    {"parse_wide_array_sparse", setup_wide_array, run_parse_sparse},
+    {"parse_deep_nesting", setup_deep_nesting, run_parse},
+    {"parse_long_string", setup_long_string, run_parse},
+    {"parse_long_string_padded", setup_long_string, run_parse_padded},
+    {"parse_records", setup_records, run_parse},
+    {"parse_records_c_str", setup_records, run_parse_c_str},
+    {"parse_records_padded", setup_records, run_parse_padded},
+    {"parse_records_values", setup_records, run_parse_values},
+    {"parse_records_projection", setup_records_projection,
+     run_parse_projection},
+    {"parse_records_chunked", setup_records, run_parse_chunked},
+    {"parse_records_chunked_mt", setup_records, run_parse_chunked_threads},
+    {"parse_messages", setup_messages, run_messages_sequential},
+    {"parse_messages_batch", setup_messages, run_messages_batch},
+    {"parse_messages_pool_1", setup_pool_1, run_messages_pool},
+    {"parse_messages_pool_2", setup_pool_2, run_messages_pool},
+    {"parse_messages_pool_4", setup_pool_4, run_messages_pool},
+    {"parse_messages_pool_8", setup_pool_8, run_messages_pool},
+    {"validate_records", setup_records, run_validate},
+    {"validate_long_string", setup_long_string, run_validate},
+    {"nav_siblings", setup_records_tree, run_siblings},
+    {"nav_siblings_soa", setup_records_tree, run_siblings_soa},
+    {"nav_element_walk", setup_records_tree, run_element_walk},
+    {"nav_element_index", setup_records_tree, run_element_index},
+    {"extract_columns", setup_records_tree, run_extract_columns},
+    {"coordinates_strtod", setup_coordinates, run_coordinates_strtod},
+    {"coordinates_tokens", setup_coordinates, run_coordinates_tokens},
+    {"coordinates_buffer", setup_coordinates, run_coordinates_buffer},
+    {"filter_ndjson", setup_log_lines, run_filter_ndjson},
+    {"filter_ndjson_parse_all", setup_log_lines, run_filter_ndjson_parse_all},
+    {"str_find_byte", setup_records, run_find_byte},
+    {"str_find_substr", setup_records, run_find_substr},
+    {"str_parse_int", setup_digits, run_parse_int},
+};
+
+#define N_BENCHMARKS (sizeof(s_benchmarks) / sizeof(s_benchmarks[0]))
+
+// *****************************************************************************
+// Public code
+
+int main(int argc, char **argv) {
+    int trials = DEFAULT_TRIALS;
+    FILE *out = stdout;
+    int first_name = argc;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            trials = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            if ((out = fopen(argv[++i], "w")) == NULL) {
+                fprintf(stderr, "could not open %s\n", argv[i]);
+                return 1;
+            }
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [-n trials] [-o results.csv] "
+                            "[benchmark_name ...]\n", argv[0]);
+            return 1;
+        } else {
+            first_name = i;
+            break;
+        }
+    }
+
+    fprintf(out, "benchmark,trial,bytes,ns\n");
+    for (size_t b = 0; b < N_BENCHMARKS; b++) {
+        const benchmark_t *bench = &s_benchmarks[b];
+        bool selected = first_name == argc;
+        for (int i = first_name; i < argc; i++) {
+            selected |= strcmp(argv[i], bench->name) == 0;
+        }
+        if (!selected) {
+            continue;
+        }
+
+        // calibrate: double reps until one trial takes at least MIN_TRIAL_NS
+        size_t bytes_per_rep = bench->setup();
+        uint64_t reps = 1;
+        while (true) {
+            uint64_t start = now_ns();
+            for (uint64_t r = 0; r < reps; r++) {
+                bench->run();
+            }
+            if (now_ns() - start >= MIN_TRIAL_NS) {
+                break;
+            }
+            reps *= 2;
+        }
+
+        for (int trial = 0; trial < trials; trial++) {
+            uint64_t start = now_ns();
+            for (uint64_t r = 0; r < reps; r++) {
+                bench->run();
+            }
+            uint64_t elapsed = now_ns() - start;
+            fprintf(out, "%s,%d,%llu,%llu\n", bench->name, trial,
+                    (unsigned long long)(bytes_per_rep * reps),
+                    (unsigned long long)elapsed);
+        }
+        fflush(out);
+        fprintf(stderr, "%s: %llu reps x %d trials\n", bench->name,
+                (unsigned long long)reps, trials);
+    }
+
+    if (s_pool_running) {
+        mu_json_batch_deinit(&s_pool);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
+
+// *****************************************************************************
+// Private (static) code
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static size_t append(size_t len, const char *cstr) {
+    while (*cstr && len < MAX_JSON_STRING) {
+        s_json[len++] = *cstr++;
+    }
+    return len;
+}
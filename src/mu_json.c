@@ -29,10 +29,12 @@
 
 #include "mu_json.h"
 
+#include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 // *****************************************************************************
@@ -46,6 +48,49 @@
 #define TRACE_PRINTF(...)
 #endif
 
+// Compile with MU_JSON_STATS defined to enable the instrumentation counters in
+// mu_json_stats_t.  STATS_ADD() and LOOKUP_*() compile to nothing otherwise.
+#ifdef MU_JSON_STATS
+#define STATS_ADD(_parser, _field, _n)                                         \
+    do {                                                                       \
+        if ((_parser)->stats) {                                                \
+            (_parser)->stats->_field += (_n);                                  \
+        }                                                                      \
+    } while (0)
+#else
+#define STATS_ADD(_parser, _field, _n)
+#endif
+
+#if defined(MU_JSON_STATS) && defined(MU_JSON_STATS_CLOCK)
+#define LOOKUP_BEGIN(_parser) uint64_t _lookup_start = MU_JSON_STATS_CLOCK
+#define LOOKUP_END(_parser)                                                    \
+    STATS_ADD(_parser, lookup_ticks, MU_JSON_STATS_CLOCK - _lookup_start);     \
+    STATS_ADD(_parser, lookups, 1)
+#else
+#define LOOKUP_BEGIN(_parser)
+#define LOOKUP_END(_parser) STATS_ADD(_parser, lookups, 1)
+#endif
+
+// With GCC or Clang, parse() dispatches on the next state through a table of
+// label addresses ("computed goto") rather than a range check followed by a
+// switch.  Define MU_JSON_NO_COMPUTED_GOTO to build the portable engine, which
+// runs every character through parser_step(), instead.
+#if defined(__GNUC__) && !defined(MU_JSON_NO_COMPUTED_GOTO)
+#define USE_COMPUTED_GOTO
+#endif
+
+// Force inlining of the per-character helpers into each engine.
+#if defined(__GNUC__)
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define ALWAYS_INLINE inline
+#endif
+
+// Label an action in perform_action() and count it in the stats.
+#define ACTION(_action)                                                        \
+    case _action:                                                              \
+        STATS_ADD(parser, actions[(_action)-NR_STATES - 1], 1);
+
 #define __ (uint8_t) - 1 /* the universal error code */
 
 // The 128 ASCII chars map into one of the following character classes.
@@ -154,9 +199,125 @@ typedef struct {
     int depth;               // current parse tree depth
     int char_pos;            // position of char being parsed
     int state;               // parser state
+    int container;           // index of innermost open container, or -1
+    bool is_key;             // true if most recent token is an object key
     mu_json_err_t error;     // error status
+    mu_json_stats_t *stats;  // optional instrumentation counters
+    mu_json_value_t *values; // optional decoded numbers, one per token
+    size_t sparse_limit;     // tokens in an array before eliding scalars
+    bool eliding;            // true if the latest token is `elided`
+    mu_json_token_t elided;  // stands in for a scalar that gets no token
+    const mu_json_projection_t *projection; // optional paths to keep
+    int skip_depth;          // depth of outermost unselected container
+    int keep_depth;          // depth of outermost wholly selected container
+    uint32_t key_mask;       // pointers matched by the most recent key
+    uint32_t path_masks[MU_JSON_PROJECT_MAX_SEGMENTS + 1]; // by child depth
+    long path_indexes[MU_JSON_PROJECT_MAX_SEGMENTS + 1];   // array positions
+    int max_depth;           // container nesting limit
+    size_t max_string;       // string length limit, 0 = unlimited
+    size_t string_limit_pos; // char_pos at which current string is too long
+    bool nul_terminated;     // true until the NUL of a C string input is seen
+    size_t readable;         // input bytes that may be loaded a word at a time
+    int prev_state;          // state prior to the most recent transition
 } parser_t;
 
+/**
+ * @brief One lane of mu_json_parse_batch(): a parser and its document.
+ */
+typedef struct {
+    parser_t parser;
+    mu_str_t json;
+    size_t doc; // index of the document in this lane
+    bool active;
+} lane_t;
+
+/**
+ * @brief How the extent of the input is known to parse().
+ */
+typedef enum {
+    INPUT_SIZED,          // exactly mu_str_length() bytes are readable
+    INPUT_NUL_TERMINATED, // length unknown until the NUL is reached
+    INPUT_PADDED,         // MU_JSON_PADDING extra bytes are readable
+} input_kind_t;
+
+/**
+ * @brief Where a chunk of a chunked parse may begin, relative to strings.
+ */
+typedef enum {
+    SCAN_OUT, // outside any string
+    SCAN_IN,  // inside a string
+    SCAN_ESC, // inside a string, just after a backslash
+} scan_state_t;
+
+/**
+ * @brief A number as scanned by scan_number(): mantissa * 10^exp10.
+ */
+typedef struct {
+    uint64_t mantissa;   // the first 19 significant digits
+    int n_digits;        // significant digits in mantissa
+    int exp10;           // power of ten to apply to mantissa
+    bool exact;          // false if nonzero digits were dropped
+    bool negative;
+    const uint8_t *text; // the digits, from the first to the exponent (if any)
+    const uint8_t *text_end;
+    int exponent;        // the exponent as written
+} number_t;
+
+// Significant digits of a number that number_to_double() hands to strtod()
+#define MAX_STRTOD_DIGITS 100
+
+// Marks a token for removal while mu_json_compact() runs; never seen outside
+#define TOKEN_FLAG_REMOVED 0x80
+
+/**
+ * @brief The state of one mu_json_path_eval().
+ */
+typedef struct {
+    const mu_json_path_t *path;
+    mu_json_path_callback_t callback;
+    void *arg;
+    int matches;  // tokens passed to the callback so far
+    bool stopped; // true once the callback has returned false
+} path_eval_t;
+
+/**
+ * @brief What mu_json_extract_columns() learned about the key at one position
+ * of the previous record.
+ */
+typedef struct {
+    const uint8_t *key; // slice of the key, with quotes, or NULL
+    size_t length;
+    int column; // index of its column, or -1 if it isn't one
+} key_prediction_t;
+
+/**
+ * @brief The element type of the typed array functions.
+ */
+typedef enum {
+    NUMBERS_DOUBLE,
+    NUMBERS_FLOAT,
+    NUMBERS_INT32,
+} numbers_kind_t;
+
+// Vector width for searching token depths (see find_depth_at_most())
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DEPTH_LANES 16
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define DEPTH_LANES 8
+#endif
+
+// SWAR ("SIMD within a register") helpers for scanning 8 bytes at a time
+#define SWAR_ONES 0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+#define SWAR_HAS_ZERO(_x) (((_x)-SWAR_ONES) & ~(_x)&SWAR_HIGHS)
+
+// Converting eight digits at once relies on little-endian loads
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SWAR_DIGITS
+#endif
+
 // *****************************************************************************
 // Private (static) storage
 
@@ -165,7 +326,7 @@ typedef struct {
  * us construct a much more compact state transition table (see below).
  */
 // clang-format off
-static int ascii_classes[128] = {
+static const uint8_t ascii_classes[128] = {
     __,      __,      __,      __,      __,      __,      __,      __,
     __,      C_WHITE, C_WHITE, __,      __,      C_WHITE, __,      __,
     __,      __,      __,      __,      __,      __,      __,      __,
@@ -196,7 +357,7 @@ static int ascii_classes[128] = {
  * mixed-case symbol and has a value greater than NR_STATES.
  */
 // clang-format off
-static int state_transition_table[NR_STATES * NR_CLASSES] = {
+static const uint8_t state_transition_table[NR_STATES * NR_CLASSES] = {
 /*             white                                      1-9                                   ABCDF  etc
            space |  {  }  [  ]  :  ,  "  \  /  +  -  .  0  |  a  b  c  d  e  f  l  n  r  s  t  u  |  E  |*/
 /*start  GO*/ GO,GO,Bo,__,Ba,__,__,__,Bs,__,__,__,Bm,__,Bz,Bd,__,__,__,__,__,Bf,__,Bn,__,__,Bt,__,__,__,__,
@@ -207,19 +368,19 @@ static int state_transition_table[NR_STATES * NR_CLASSES] = {
 /*value  VA*/ VA,VA,Bo,__,Ba,__,__,__,Bs,__,__,__,Bm,__,Bz,Bd,__,__,__,__,__,Bf,__,Bn,__,__,Bt,__,__,__,__,
 /*array  AR*/ AR,AR,Bo,__,Ba,Fa,__,__,Bs,__,__,__,Bm,__,Bz,Bd,__,__,__,__,__,Bf,__,Bn,__,__,Bt,__,__,__,__,
 /*string ST*/ ST,__,ST,ST,ST,ST,ST,ST,Pq,ES,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
-/*escape ES*/ __,__,__,__,__,__,__,__,Bs,ST,ST,__,__,__,__,__,__,ST,__,__,__,ST,__,ST,ST,__,ST,U1,__,__,__,
+/*escape ES*/ __,__,__,__,__,__,__,__,ST,ST,ST,__,__,__,__,__,__,ST,__,__,__,ST,__,ST,ST,__,ST,U1,__,__,__,
 /*u1     U1*/ __,__,__,__,__,__,__,__,__,__,__,__,__,__,U2,U2,U2,U2,U2,U2,U2,U2,__,__,__,__,__,__,U2,U2,__,
 /*u2     U2*/ __,__,__,__,__,__,__,__,__,__,__,__,__,__,U3,U3,U3,U3,U3,U3,U3,U3,__,__,__,__,__,__,U3,U3,__,
 /*u3     U3*/ __,__,__,__,__,__,__,__,__,__,__,__,__,__,U4,U4,U4,U4,U4,U4,U4,U4,__,__,__,__,__,__,U4,U4,__,
 /*u4     U4*/ __,__,__,__,__,__,__,__,__,__,__,__,__,__,ST,ST,ST,ST,ST,ST,ST,ST,__,__,__,__,__,__,ST,ST,__,
 /*minus  MI*/ __,__,__,__,__,__,__,__,__,__,__,__,__,__,ZE,IN,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
-/*zero   ZE*/ Ps,OK,__,Fo,__,Fa,__,Pm,__,__,__,__,__,Pd,__,__,__,__,__,__,Px,__,__,__,__,__,__,__,__,Px,__,
+/*zero   ZE*/ Ps,Ps,__,Fo,__,Fa,__,Pm,__,__,__,__,__,Pd,__,__,__,__,__,__,Px,__,__,__,__,__,__,__,__,Px,__,
 /*int    IN*/ Ps,Ps,__,Fo,__,Fa,__,Pm,__,__,__,__,__,Pd,IN,IN,__,__,__,__,Px,__,__,__,__,__,__,__,__,Px,__,
 /*frac   FR*/ __,__,__,__,__,__,__,__,__,__,__,__,__,__,FS,FS,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
-/*fracs  FS*/ Ps,OK,__,Fo,__,Fa,__,Pm,__,__,__,__,__,__,FS,FS,__,__,__,__,Px,__,__,__,__,__,__,__,__,Px,__,
+/*fracs  FS*/ Ps,Ps,__,Fo,__,Fa,__,Pm,__,__,__,__,__,__,FS,FS,__,__,__,__,Px,__,__,__,__,__,__,__,__,Px,__,
 /*e      E1*/ __,__,__,__,__,__,__,__,__,__,__,E2,E2,__,E3,E3,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
 /*ex     E2*/ __,__,__,__,__,__,__,__,__,__,__,__,__,__,E3,E3,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
-/*exp    E3*/ Ps,OK,__,Fo,__,Fa,__,Pm,__,__,__,__,__,__,E3,E3,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+/*exp    E3*/ Ps,Ps,__,Fo,__,Fa,__,Pm,__,__,__,__,__,__,E3,E3,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
 /*tr     T1*/ __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,T2,__,__,__,__,__,__,
 /*tru    T2*/ __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,T3,__,__,__,
 /*true   T3*/ __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,OK,__,__,__,__,__,__,__,__,__,__,
@@ -248,10 +409,6 @@ token_type_name(mu_json_token_type_t token_type) {
     }
 }
 
-// *****************************************************************************
-// start DEBUG_TRACE support
-#ifdef DEBUG_TRACE
-
 #define EXPAND_CH_CLASS_NAMES(_name) #_name,
 __attribute__((unused)) static const char *s_ch_class_names[] = {
     DEFINE_CHAR_CLASSES(EXPAND_CH_CLASS_NAMES)};
@@ -262,12 +419,29 @@ __attribute__((unused)) static const char *s_ch_class_names[] = {
 __attribute__((unused)) static const char *s_state_names[] = {
     DEFINE_STATES(EXPAND_STATE_NAMES)};
 
+#define N_STATES sizeof(s_state_names) / sizeof(s_state_names[0])
+
+// Bytes that can change the string state or depth seen by a chunk scan
+static const uint8_t s_scan_bytes[256] = {
+    ['"'] = 1, ['\\'] = 1, ['['] = 1, [']'] = 1, ['{'] = 1, ['}'] = 1,
+};
+
+// Action states follow NR_STATES
+_Static_assert(sizeof(s_state_names) / sizeof(s_state_names[0]) ==
+                   NR_STATES + 1 + MU_JSON_STATS_N_ACTIONS,
+               "MU_JSON_STATS_N_ACTIONS does not match DEFINE_STATES");
+
+_Static_assert(MU_JSON_PROJECT_MAX_POINTERS <= 32,
+               "projection masks hold at most 32 pointers");
+
+// *****************************************************************************
+// start DEBUG_TRACE support
+#ifdef DEBUG_TRACE
+
 #define EXPAND_STATE_DESCRIPTIONS(_name, _description) _description,
 __attribute__((unused)) static const char *s_state_descriptions[] = {
     DEFINE_STATES(EXPAND_STATE_DESCRIPTIONS)};
 
-#define N_STATES sizeof(s_state_names) / sizeof(s_state_names[0])
-
 __attribute__((unused)) static const char *ch_class_name(ch_class_t ch_class) {
     if (ch_class >= 0 && ch_class < N_CH_CLASSES) {
         return s_ch_class_names[ch_class];
@@ -312,7 +486,102 @@ __attribute__((unused)) static const char *error_name(mu_json_err_t error) {
 // Private (forward) declarations
 
 static int parse(mu_json_token_t *tokens, size_t max_tokens,
-                 mu_str_t *json_input);
+                 mu_str_t *json_input, mu_json_parse_opts_t *opts,
+                 input_kind_t input);
+
+/**
+ * @brief Prepare a parser to parse json_input.
+ *
+ * Return false if the input is rejected without being scanned (see
+ * max_bytes), in which case parser_finish() reports the error.
+ */
+static bool parser_init(parser_t *parser, mu_json_token_t *tokens,
+                        size_t max_tokens, mu_str_t *json_input,
+                        mu_json_parse_opts_t *opts, input_kind_t input);
+
+/**
+ * @brief Run an initialized parser to the end of its input or to the first
+ * error.  Uses the threaded dispatch loop when USE_COMPUTED_GOTO is defined.
+ */
+static void parser_run(parser_t *parser);
+
+/**
+ * @brief Process the character at parser->char_pos and advance past it.
+ *
+ * This is the general path that handles everything: strings, limits, end of
+ * input and the NUL of C string inputs.  Return false once the end of input
+ * has been processed or an error has been detected.
+ */
+static ALWAYS_INLINE bool parser_step(parser_t *parser);
+
+/**
+ * @brief Perform one of the action states (those following NR_STATES).
+ *
+ * Inlined with a constant action, this compiles to just that action.
+ */
+static ALWAYS_INLINE void perform_action(parser_t *parser, int action);
+
+/**
+ * @brief Finish parsing: mark the last token, or report the error and unwind
+ * any open containers.  Return the token count or a negative error code.
+ */
+static int parser_finish(parser_t *parser, mu_json_parse_opts_t *opts);
+
+/**
+ * @brief Return the offset just past the first comma between two elements of
+ * the root at or after `pos` and before `end`, or 0 if there is none.
+ *
+ * `state` and `depth` give the string state and nesting depth at `pos`.
+ */
+static size_t find_split(const uint8_t *buf, size_t pos, size_t end,
+                         int state, int32_t depth);
+
+/**
+ * @brief Return the index of the first of depths[from..to) that is <= depth,
+ * or `to` if there is none.
+ */
+static size_t find_depth_at_most(const int16_t *depths, size_t from,
+                                 size_t to, int depth);
+
+/**
+ * @brief Return the index of the last of depths[0..before) that is <= depth,
+ * or -1 if there is none.
+ */
+static int rfind_depth_at_most(const int16_t *depths, int before, int depth);
+
+/**
+ * @brief Advance a chunk scan's string state (a scan_state_t) and nesting
+ * depth past one byte, returning the new state.
+ */
+static inline int scan_byte(int state, int32_t *depth, uint8_t ch);
+
+#if MU_JSON_BATCH_LANES > 1
+/**
+ * @brief Advance a batch lane by one character, handling transitions and
+ * actions inline and anything else through parser_step().  Return false when
+ * parsing is done.
+ */
+static ALWAYS_INLINE bool lane_step(parser_t *parser);
+
+/**
+ * @brief Start the next unparsed document in a lane, finishing any documents
+ * rejected before scanning.  Return false if there are no more documents.
+ */
+static bool lane_start(lane_t *lane, mu_json_batch_doc_t *docs, size_t n_docs,
+                       size_t *next_doc, mu_json_parse_opts_t *opts,
+                       size_t *n_parsed);
+#endif
+
+/**
+ * @brief Return the position of the first byte at or after pos that ends an
+ * ordinary run of string characters (a quote, backslash or control char), or
+ * end if there is none before end.
+ *
+ * Bytes are examined 8 at a time while buf[0..readable) covers the load, then
+ * one at a time up to end.
+ */
+static size_t skip_string_body(const uint8_t *buf, size_t pos, size_t end,
+                               size_t readable);
 
 /**
  * @brief Return the character class for the given character.
@@ -346,6 +615,107 @@ static bool begin_token(parser_t *parser, mu_json_token_type_t type);
 static void finish_token(parser_t *parser, mu_json_token_t *token,
                          bool incl_delim);
 
+/**
+ * @brief Scan a JSON number starting at p into `num`.
+ *
+ * Set `is_integer` if the number has no fraction or exponent.  Return a
+ * pointer just past the number, or NULL if p doesn't start a valid number.
+ * Scanning stops at the first byte that can't continue the number; the caller
+ * checks what follows.
+ */
+static const uint8_t *scan_number(const uint8_t *p, const uint8_t *end,
+                                  number_t *num, bool *is_integer);
+
+/**
+ * @brief Accumulate a run of digits into `num`, keeping the first 19
+ * significant digits.  Return a pointer to the first non-digit.
+ */
+static const uint8_t *scan_digits(const uint8_t *p, const uint8_t *end,
+                                  number_t *num, bool in_fraction);
+
+/**
+ * @brief Return a scanned number as an int64_t, saturating if it is out of
+ * range.
+ */
+static int64_t number_to_int64(const number_t *num);
+
+/**
+ * @brief Return a scanned number as a correctly rounded double.
+ *
+ * A number with at most 19 significant digits and a small exponent is
+ * converted exactly by one multiplication or division; any other is handed to
+ * strtod() as "<digits>e<exponent>".
+ */
+static double number_to_double(const number_t *num);
+
+/**
+ * @brief Store a scanned number as out[i], converting it to `kind`.  Return
+ * MU_JSON_ERR_NONE or an error (see @ref typed_arrays).
+ */
+static int store_number(void *out, size_t i, numbers_kind_t kind,
+                        const number_t *num, bool is_integer);
+
+/**
+ * @brief Return the index of the column named by a key token's slice, or -1
+ * if there is none.  Try the column predicted for this key position first.
+ */
+static int find_column(mu_json_extractor_t *extractor,
+                       key_prediction_t *predicted, int position,
+                       mu_str_t *key);
+
+/**
+ * @brief Store a value token in row `row` of a column, or zero the row and
+ * clear its validity bit if the token is null or of the wrong type.
+ */
+static void store_column(mu_json_column_t *column, size_t row,
+                         mu_json_token_t *value);
+
+/**
+ * @brief Common code for the mu_json_array_to_*() functions.
+ */
+static int tokens_to_numbers(mu_json_token_t *array, void *out,
+                             size_t max_out, numbers_kind_t kind);
+
+/**
+ * @brief Common code for the mu_json_buffer_to_*() functions.
+ */
+static int buffer_to_numbers(const uint8_t *buf, size_t buflen, void *out,
+                             size_t max_out, numbers_kind_t kind);
+
+/**
+ * @brief Return a pointer to the first non-whitespace byte at or after p.
+ */
+static const uint8_t *skip_whitespace(const uint8_t *p, const uint8_t *end);
+
+/**
+ * @brief Return true if ch is an ASCII digit.
+ */
+static inline bool is_digit(uint8_t ch) {
+    return (uint8_t)(ch - '0') < 10;
+}
+
+#if defined(SWAR_DIGITS)
+/**
+ * @brief Return true if all eight bytes of x are ASCII digits: each has a
+ * high nibble of 3, and adding 6 doesn't carry out of its low nibble.
+ */
+static inline bool swar_is_eight_digits(uint64_t x) {
+    return ((x & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((x + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+           0x3333333333333333ULL;
+}
+
+/**
+ * @brief Convert eight ASCII digits, loaded little-endian, to their value by
+ * combining pairs of digits, then pairs of pairs, then the two halves.
+ */
+static inline uint32_t swar_eight_digits(uint64_t x) {
+    x = (x & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+    x = (x & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+    return (uint32_t)((x & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+}
+#endif
+
 /**
  * @brief Map a (state, char_class) pair to a new state.
  */
@@ -353,6 +723,27 @@ static inline int lookup_state(int state, int char_class) {
     return state_transition_table[state * NR_CLASSES + char_class];
 }
 
+/**
+ * @brief Map a (state, input byte) pair to a new state, or to __ if the byte
+ * is illegal or not accepted in this state.
+ *
+ * Built with MU_JSON_FUSED_TABLE, this is a single load from a table that
+ * folds classify_char() into the state transitions (see tools/).  Otherwise
+ * it classifies the byte, then looks up the transition.
+ */
+static inline int lookup_byte(int state, uint8_t ch);
+
+/**
+ * @brief Convert an INTEGER token to a NUMBER (e.g. on seeing `.` or `e`).
+ */
+static inline void promote_to_number(parser_t *parser, mu_json_token_t *token) {
+    if (token->type == MU_JSON_TOKEN_TYPE_INTEGER) {
+        STATS_ADD(parser, tokens[MU_JSON_TOKEN_TYPE_INTEGER], -1);
+        STATS_ADD(parser, tokens[MU_JSON_TOKEN_TYPE_NUMBER], 1);
+    }
+    token->type = MU_JSON_TOKEN_TYPE_NUMBER;
+}
+
 /**
  * @brief Return true if token is an OBJECT or ARRAY
  */
@@ -406,40 +797,215 @@ static inline void set_is_last(mu_json_token_t *token) {
 }
 
 /**
- * @brief "Top of Stack": Return the most recently allocated token or NULL if
- * none have been allocated.
+ * @brief Return true if a token of the given type, about to begin, is a
+ * scalar element of an array and so may be elided by a sparse parse.
+ */
+static bool should_elide(parser_t *parser, mu_json_token_type_t type);
+
+/**
+ * @brief Return true if a complete token is an object key: a string followed
+ * by a colon.
+ */
+static bool is_object_key(mu_json_token_t *token);
+
+/**
+ * @brief Return the index just past the last descendant of tokens[i].
+ */
+static int subtree_end(mu_json_token_t *tokens, int n_tokens, int i);
+
+/**
+ * @brief Copy the document described by the tokens into `buf`, or only
+ * measure it if `buf` is NULL.  Return its length.
+ */
+static size_t copy_tokens(mu_json_token_t *tokens, int n_tokens,
+                          uint8_t *buf);
+
+/**
+ * @brief Compile a name or `*` at *pp into `name`, advancing *pp past it.
+ */
+static mu_json_err_t compile_name(const char **pp, mu_json_path_name_t *name);
+
+/**
+ * @brief Compile the step in brackets starting just past the `[` at *pp,
+ * advancing *pp past the `]`.
+ */
+static mu_json_err_t compile_bracket(const char **pp,
+                                     mu_json_path_step_t *step);
+
+/**
+ * @brief Compile the body of a filter, `@.a.b op literal`, at *pp.
+ */
+static mu_json_err_t compile_filter(const char **pp,
+                                    mu_json_path_step_t *step);
+
+/**
+ * @brief Compile the literal at *pp that a filter compares with.
+ */
+static mu_json_err_t compile_literal(const char **pp,
+                                     mu_json_path_step_t *step);
+
+/**
+ * @brief Apply steps k onward of the path to `token`.
+ */
+static void eval_step(path_eval_t *eval, int k, mu_json_token_t *token);
+
+/**
+ * @brief Return true if the value meets the filter step's condition.
+ */
+static bool filter_matches(const mu_json_path_step_t *step,
+                           mu_json_token_t *value);
+
+/**
+ * @brief Return the value of the object's member with the given key, or NULL
+ * if it has none or isn't an object.
+ */
+static mu_json_token_t *find_member(mu_json_token_t *object,
+                                    const mu_json_path_name_t *key);
+
+/**
+ * @brief Return true if the contents of a STRING token are `name`.
+ */
+static bool name_matches(mu_json_token_t *string,
+                         const mu_json_path_name_t *name);
+
+/**
+ * @brief Return the first element or member value of a container, or NULL.
+ */
+static mu_json_token_t *first_value(mu_json_token_t *container);
+
+/**
+ * @brief Return the element or member value of a container after `value`, or
+ * NULL.
+ */
+static mu_json_token_t *next_value(mu_json_token_t *container,
+                                   mu_json_token_t *value);
+
+/**
+ * @brief Parse a record that passed the prefilter and test its fields.
+ */
+static bool filter_record(mu_json_filter_t *filter, const uint8_t *record,
+                          size_t length);
+
+/**
+ * @brief Return the field that the filter's p'th pointer refers to, or NULL.
+ */
+static mu_json_token_t *resolve_pointer(mu_json_filter_t *filter, int p);
+
+/**
+ * @brief Return true if `field` (NULL if absent) meets the predicate.
+ */
+static bool predicate_matches(const mu_json_filter_predicate_t *predicate,
+                              mu_json_token_t *field);
+
+/**
+ * @brief Return true if a token of the given type, about to begin, must get a
+ * token in a projection parse: it is on or under a selected path, it is a key
+ * (decided by project_key() once complete), or it is a container (released by
+ * project_close() if unselected).
+ */
+static bool project_token(parser_t *parser, mu_json_token_type_t type,
+                          bool is_key);
+
+/**
+ * @brief Match a just-completed object key against the projection, releasing
+ * its token if no pointer continues through it.
+ */
+static void project_key(parser_t *parser, mu_json_token_t *key);
+
+/**
+ * @brief Leave the container at `index`, which has just closed, releasing its
+ * tokens if it wasn't selected.
+ */
+static void project_close(parser_t *parser, int index);
+
+/**
+ * @brief Give back every token from `index` onward.  The sealed stand-in
+ * becomes the most recent token.
+ */
+static void release_tokens(parser_t *parser, int index);
+
+/**
+ * @brief Return true if the JSON Pointer segment (with ~0 and ~1 escapes)
+ * names the key `buf`.
+ */
+static bool segment_matches(const mu_json_pointer_segment_t *segment,
+                            const uint8_t *buf, size_t length);
+
+/**
+ * @brief "Top of Stack": Return the most recently begun token -- the stand-in
+ * if that one was elided -- or NULL if none have been begun.
  */
 static mu_json_token_t *tos(parser_t *parser);
 
 /**
- * @brief return a new state depending on several factors.
+ * @brief Return the innermost open container or NULL if none is open.
+ */
+static mu_json_token_t *open_container(parser_t *parser);
+
+/**
+ * @brief Make the most recently allocated token the innermost open container.
  *
- * @param token Most recently allocated token
- * @param not_in_container State to be returned if token is not in a container
- * @param in_array State to be returned if token is inside an array
- * @param in_object_key State to be returned if token is an object key.
- * @param in_object_value State to be returned if token is an object value.
- * @return One of the above four values.
+ * Sets a LIMIT error if this would exceed the parser's max_depth.
+ * While a container is open, its slice length is meaningless (it extends to
+ * the end of the input), so we borrow that field to remember the index of the
+ * enclosing container.  This gives O(1) access to the parent without a
+ * backwards search through the token store.
  */
-static int select_state(mu_json_token_t *token, int not_in_container,
-                        int in_array, int in_object_key, int in_object_value);
+static void push_container(parser_t *parser);
 
 /**
- * @brief Return the number of top-level children inside container, stopping
- * when token is encountered.
+ * @brief Finish the innermost open container and re-open the enclosing one.
  *
- * IMPORTANT: container must be a parent of token.
+ * Sets a BAD_FORMAT error if no container is open or if the innermost open
+ * container is not of the given type (e.g. `[1}`).
  */
-static int child_count(mu_json_token_t *container, mu_json_token_t *token);
+static void pop_container(parser_t *parser, mu_json_token_type_t type);
+
+/**
+ * @brief Following an error, restore the slices of any still-open containers
+ * to extend to the end of the input (see push_container()).
+ */
+static void unwind_containers(parser_t *parser);
+
+/**
+ * @brief return a new state depending on the innermost open container.
+ *
+ * @param parser The parser.
+ * @param not_in_container State to be returned if not in a container
+ * @param in_array State to be returned if inside an array
+ * @param after_value State to be returned if the most recent token is an
+ *        object value.
+ * @param after_key State to be returned if the most recent token is an
+ *        object key.
+ * @return One of the above four values.
+ */
+static int select_state(parser_t *parser, int not_in_container, int in_array,
+                        int after_value, int after_key);
 
 /**
  * @brief Set the parser state.  If DEBUG_TRACE in effect, print transition.
+ *
+ * Setting the state to __ (e.g. as returned by select_state()) flags a format
+ * error.
  */
 static inline void set_state(parser_t *parser, int state) {
+    if (state == __) {
+        parser->error = MU_JSON_ERR_BAD_FORMAT;
+    }
     parser->state = state;
     TRACE_PRINTF(" => %s", state_name(parser->state));
 }
 
+/**
+ * @brief Fill in the caller's error report following a failed parse.
+ *
+ * This is only called on the error path, so the line and column are computed
+ * here (by re-scanning the input up to the error) rather than being tracked
+ * while parsing.
+ */
+static void report_error(parser_t *parser, mu_json_error_info_t *info,
+                         mu_json_err_t err, int state, int char_class);
+
 /**
  * @brief Return a string describing the token.
  *
@@ -453,43 +1019,448 @@ __attribute__((unused)) static char *token_string(mu_json_token_t *token);
 
 int mu_json_parse_c_str(mu_json_token_t *token_store, size_t max_tokens,
                         const char *json, void *arg) {
-    (void)arg; // reserved for future use
     mu_str_t mu_str;
-    return parse(token_store, max_tokens, mu_str_init_cstr(&mu_str, json));
+    // Parse in a single pass: the length is discovered when the parser reaches
+    // the NUL terminator rather than by a strlen() beforehand.
+    return parse(token_store, max_tokens,
+                 mu_str_init(&mu_str, (const uint8_t *)json, INT_MAX), arg,
+                 INPUT_NUL_TERMINATED);
 }
 
 int mu_json_parse_mu_str(mu_json_token_t *token_store, size_t max_tokens,
                          mu_str_t *mu_json, void *arg) {
-    (void)arg; // reserved for future use
-    return parse(token_store, max_tokens, mu_json);
+    return parse(token_store, max_tokens, mu_json, arg, INPUT_SIZED);
 }
 
 int mu_json_parse_buffer(mu_json_token_t *token_store, size_t max_tokens,
                          const uint8_t *buf, size_t buflen, void *arg) {
-    (void)arg; // reserved for future use
     mu_str_t mu_str;
-    return parse(token_store, max_tokens, mu_str_init(&mu_str, buf, buflen));
+    return parse(token_store, max_tokens, mu_str_init(&mu_str, buf, buflen),
+                 arg, INPUT_SIZED);
 }
 
-mu_str_t *mu_json_token_slice(mu_json_token_t *token) {
-    if (token == NULL) {
+int mu_json_parse_padded(mu_json_token_t *token_store, size_t max_tokens,
+                         const uint8_t *buf, size_t buflen, void *arg) {
+    mu_str_t mu_str;
+    return parse(token_store, max_tokens, mu_str_init(&mu_str, buf, buflen),
+                 arg, INPUT_PADDED);
+}
+
+uint8_t *mu_json_pad_buffer(uint8_t *dst, size_t dst_size, const uint8_t *src,
+                            size_t srclen) {
+    if (dst_size < srclen || dst_size - srclen < MU_JSON_PADDING) {
         return NULL;
-    } else {
-        return &token->json;
     }
+    memmove(dst, src, srclen); // src may already be in dst
+    memset(&dst[srclen], 0, MU_JSON_PADDING);
+    return dst;
 }
 
-mu_json_token_type_t mu_json_token_type(mu_json_token_t *token) {
-    if (token == NULL) {
-        return MU_JSON_TOKEN_TYPE_UNKNOWN;
-    } else {
-        return token->type;
+size_t mu_json_parse_batch(mu_json_batch_doc_t *docs, size_t n_docs,
+                           void *arg) {
+    mu_json_parse_opts_t opts = {0};
+    size_t n_parsed = 0;
+
+    if (arg) {
+        opts = *(mu_json_parse_opts_t *)arg;
+        opts.error = NULL;  // one report can't describe a batch
+        opts.values = NULL; // nor can one values array
     }
-}
 
-int mu_json_token_depth(mu_json_token_t *token) {
-    if (token == NULL) {
-        return -1;
+#if MU_JSON_BATCH_LANES > 1
+    lane_t lanes[MU_JSON_BATCH_LANES];
+    size_t next_doc = 0;
+    int n_active = 0;
+
+    for (int i = 0; i < MU_JSON_BATCH_LANES; i++) {
+        lanes[i].active =
+            lane_start(&lanes[i], docs, n_docs, &next_doc, &opts, &n_parsed);
+        n_active += lanes[i].active;
+    }
+
+    while (n_active > 0) {
+        // Advance every active lane by one character.  The lanes' lookups
+        // are independent, so the CPU can overlap them.
+        for (int i = 0; i < MU_JSON_BATCH_LANES; i++) {
+            lane_t *lane = &lanes[i];
+            if (!lane->active || lane_step(&lane->parser)) {
+                continue;
+            }
+            int result = parser_finish(&lane->parser, &opts);
+            docs[lane->doc].result = result;
+            n_parsed += result > 0;
+            if (!lane_start(lane, docs, n_docs, &next_doc, &opts,
+                            &n_parsed)) {
+                lane->active = false;
+                n_active -= 1;
+            }
+        }
+    }
+#else
+    for (size_t i = 0; i < n_docs; i++) {
+        mu_str_t json;
+        mu_json_batch_doc_t *doc = &docs[i];
+        doc->result = parse(doc->tokens, doc->max_tokens,
+                            mu_str_init(&json, doc->buf, doc->buflen), &opts,
+                            INPUT_SIZED);
+        n_parsed += doc->result > 0;
+    }
+#endif
+    return n_parsed;
+}
+
+size_t mu_json_chunked_init(mu_json_chunked_t *chunked,
+                            mu_json_token_t *token_store, size_t max_tokens,
+                            const uint8_t *buf, size_t buflen,
+                            size_t n_chunks, void *arg) {
+    mu_json_parse_opts_t *opts = (mu_json_parse_opts_t *)arg;
+
+    chunked->tokens = token_store;
+    chunked->max_tokens = max_tokens;
+    chunked->buf = buf;
+    chunked->buflen = buflen;
+    chunked->arg = opts;
+    if (opts) {
+        chunked->opts = *opts;
+    } else {
+        memset(&chunked->opts, 0, sizeof(chunked->opts));
+    }
+    if (n_chunks > MU_JSON_MAX_CHUNKS) {
+        n_chunks = MU_JSON_MAX_CHUNKS;
+    }
+    if (n_chunks > buflen) {
+        n_chunks = buflen;
+    }
+    if (n_chunks < 1) {
+        n_chunks = 1;
+    }
+    for (size_t i = 0; i < n_chunks; i++) {
+        chunked->chunks[i].start = buflen * i / n_chunks;
+        chunked->chunks[i].end = buflen * (i + 1) / n_chunks;
+    }
+    chunked->n_chunks = n_chunks;
+    return n_chunks;
+}
+
+void mu_json_chunked_scan(mu_json_chunked_t *chunked, size_t i) {
+    mu_json_chunk_t *chunk = &chunked->chunks[i];
+    const uint8_t *buf = chunked->buf;
+    // One track per state the chunk may begin in.  Only one track is right,
+    // but which one isn't known until the preceding chunks are scanned.
+    uint8_t state[3] = {SCAN_OUT, SCAN_IN, SCAN_ESC};
+    int32_t depth[3] = {0, 0, 0};
+    bool escaped = true; // true if any track is in SCAN_ESC
+    size_t pos = chunk->start;
+
+    while (pos < chunk->end) {
+        if (!escaped) {
+            // Other bytes can't change any track: skip them quickly.
+            while (pos < chunk->end && !s_scan_bytes[buf[pos]]) {
+                pos += 1;
+            }
+            if (pos == chunk->end) {
+                break;
+            }
+        }
+        escaped = false;
+        for (int h = 0; h < 3; h++) {
+            state[h] = scan_byte(state[h], &depth[h], buf[pos]);
+            escaped |= state[h] == SCAN_ESC;
+        }
+        pos += 1;
+    }
+    for (int h = 0; h < 3; h++) {
+        chunk->exit_state[h] = state[h];
+        chunk->depth_delta[h] = depth[h];
+    }
+}
+
+size_t mu_json_chunked_plan(mu_json_chunked_t *chunked) {
+    const uint8_t *buf = chunked->buf;
+    size_t buflen = chunked->buflen;
+    size_t n_scanned = chunked->n_chunks;
+    size_t n_chunks = 1;
+    size_t pos = 0;
+    int state = SCAN_OUT;
+    int32_t depth = 0;
+
+    // Until the plan succeeds, mu_json_chunked_finish() parses serially.
+    chunked->n_chunks = 0;
+    if (n_scanned < 2 || chunked->opts.stats != NULL ||
+        chunked->opts.values != NULL || chunked->opts.sparse_arrays ||
+        chunked->opts.projection != NULL ||
+        (chunked->opts.max_bytes > 0 && buflen > chunked->opts.max_bytes)) {
+        // nothing to split, or per-chunk stats, values, sparse arrays,
+        // projections or limits would differ
+        return 0;
+    }
+    while (pos < buflen && classify_char(buf[pos]) == C_SPACE) {
+        pos += 1;
+    }
+    if (pos == buflen || (buf[pos] != '[' && buf[pos] != '{')) {
+        // only the elements of a root container can be split
+        return 0;
+    }
+    chunked->root_start = pos;
+    chunked->root_type = buf[pos] == '[' ? MU_JSON_TOKEN_TYPE_ARRAY
+                                         : MU_JSON_TOKEN_TYPE_OBJECT;
+
+    for (size_t i = 1; i < n_scanned; i++) {
+        // Chain the scans: the state at the end of span i-1 is the state at
+        // the start of span i.
+        mu_json_chunk_t *prev = &chunked->chunks[i - 1];
+        size_t start = chunked->chunks[i].start;
+        size_t end = chunked->chunks[i].end;
+        depth += prev->depth_delta[state];
+        state = prev->exit_state[state];
+        size_t split = find_split(buf, start, end, state, depth);
+        if (split > 0) {
+            chunked->chunks[n_chunks - 1].end = split;
+            chunked->chunks[n_chunks++].start = split;
+        }
+    }
+    if (n_chunks < 2) {
+        return 0;
+    }
+    chunked->chunks[n_chunks - 1].end = buflen;
+
+    // Give each chunk a share of the token store proportional to its length
+    size_t max_tokens = chunked->max_tokens;
+    for (size_t i = 0; i < n_chunks; i++) {
+        mu_json_chunk_t *chunk = &chunked->chunks[i];
+        chunk->token_base =
+            (size_t)((uint64_t)max_tokens * chunk->start / buflen);
+        chunk->token_limit =
+            (size_t)((uint64_t)max_tokens * chunk->end / buflen) -
+            chunk->token_base;
+        chunk->result = MU_JSON_ERR_NONE;
+    }
+    chunked->n_chunks = n_chunks;
+    return n_chunks;
+}
+
+void mu_json_chunked_parse(mu_json_chunked_t *chunked, size_t i) {
+    mu_json_chunk_t *chunk = &chunked->chunks[i];
+    mu_json_parse_opts_t opts = chunked->opts;
+    parser_t parser;
+    mu_str_t json;
+
+    // Slices are taken from the whole input so offsets need no adjustment.
+    mu_str_init(&json, chunked->buf, chunk->end);
+    opts.error = NULL;
+    parser_init(&parser, &chunked->tokens[chunk->token_base],
+                chunk->token_limit, &json, &opts, INPUT_SIZED);
+    parser.readable = chunked->buflen;
+    bool is_array = chunked->root_type == MU_JSON_TOKEN_TYPE_ARRAY;
+    if (i > 0) {
+        // Resume where the serial parser stands after the comma that ended
+        // the previous chunk: inside the root, expecting its next element.
+        // A stand-in for the root takes the region's first token.
+        if (!begin_token(&parser, chunked->root_type)) {
+            chunk->result = MU_JSON_ERR_NO_TOKENS;
+            return;
+        }
+        mu_str_slice(&parser.tokens[0].json, &json, chunked->root_start,
+                     MU_STR_END);
+        push_container(&parser);
+        parser.char_pos = chunk->start;
+        parser.state = parser.prev_state = is_array ? VA : KE;
+    }
+    parser_run(&parser);
+
+    if (i + 1 == chunked->n_chunks) {
+        // the last chunk closes the root and runs the serial endgame
+        chunk->result = parser_finish(&parser, NULL);
+    } else if (parser.error != MU_JSON_ERR_NONE) {
+        chunk->result = parser.error;
+    } else if (parser.depth != 1 || parser.state != (is_array ? VA : KE)) {
+        // didn't end where the next chunk begins
+        chunk->result = MU_JSON_ERR_BAD_FORMAT;
+    } else {
+        chunk->result = parser.token_count;
+    }
+}
+
+int mu_json_chunked_finish(mu_json_chunked_t *chunked) {
+    mu_json_token_t *tokens = chunked->tokens;
+    size_t n_chunks = chunked->n_chunks;
+    mu_str_t json;
+    bool ok = n_chunks >= 2;
+
+    for (size_t i = 0; ok && i < n_chunks; i++) {
+        ok = chunked->chunks[i].result > 0;
+    }
+    if (!ok) {
+        // Not split, or a chunk failed: the serial parse gives the exact
+        // result and error report.
+        return parse(tokens, chunked->max_tokens,
+                     mu_str_init(&json, chunked->buf, chunked->buflen),
+                     chunked->arg, INPUT_SIZED);
+    }
+
+    // Pack each chunk's tokens, less its stand-in root, after the previous
+    // chunk's.  The last chunk's stand-in was closed with the root's slice.
+    mu_json_token_t root = tokens[chunked->chunks[n_chunks - 1].token_base];
+    size_t count = chunked->chunks[0].result;
+    for (size_t i = 1; i < n_chunks; i++) {
+        mu_json_chunk_t *chunk = &chunked->chunks[i];
+        size_t n_tokens = chunk->result - 1;
+        memmove(&tokens[count], &tokens[chunk->token_base + 1],
+                n_tokens * sizeof(mu_json_token_t));
+        count += n_tokens;
+    }
+    tokens[0].json = root.json;
+    tokens[0].flags = root.flags;
+    if (chunked->arg && chunked->arg->error) {
+        memset(chunked->arg->error, 0, sizeof(mu_json_error_info_t));
+        chunked->arg->error->container = -1;
+    }
+    return (int)count;
+}
+
+int mu_json_parse_chunked(mu_json_token_t *token_store, size_t max_tokens,
+                          const uint8_t *buf, size_t buflen, size_t n_chunks,
+                          void *arg) {
+    mu_json_chunked_t chunked;
+
+    n_chunks = mu_json_chunked_init(&chunked, token_store, max_tokens, buf,
+                                    buflen, n_chunks, arg);
+    for (size_t i = 0; i < n_chunks; i++) {
+        mu_json_chunked_scan(&chunked, i);
+    }
+    n_chunks = mu_json_chunked_plan(&chunked);
+    for (size_t i = 0; i < n_chunks; i++) {
+        mu_json_chunked_parse(&chunked, i);
+    }
+    return mu_json_chunked_finish(&chunked);
+}
+
+mu_json_err_t mu_json_validate(const uint8_t *buf, size_t buflen) {
+    // One bit per open container: 1 = object, 0 = array
+    uint8_t is_object[(MU_JSON_VALIDATE_MAX_DEPTH + 7) / 8];
+    int depth = 0;
+    int state = GO;
+    bool is_key = false; // true if most recent value is an object key
+
+    for (size_t i = 0; i <= buflen; i++) {
+        if (state == ST) {
+            // Fast path: skip ordinary string bytes without table lookups.
+            i = skip_string_body(buf, i, buflen, buflen);
+        }
+        // end of input acts as a trailing space, as in parse()
+        int next_state = i == buflen ? lookup_state(state, C_SPACE)
+                                     : lookup_byte(state, buf[i]);
+        if (next_state < NR_STATES) {
+            state = next_state;
+            continue;
+        }
+
+        bool in_object = depth > 0 && (is_object[(depth - 1) >> 3] &
+                                       (1 << ((depth - 1) & 7)));
+        switch (next_state) {
+        case Ba:
+        case Bo:
+            if (depth >= MU_JSON_VALIDATE_MAX_DEPTH) {
+                return MU_JSON_ERR_LIMIT;
+            }
+            if (next_state == Bo) {
+                is_object[depth >> 3] |= 1 << (depth & 7);
+                state = OB;
+            } else {
+                is_object[depth >> 3] &= ~(1 << (depth & 7));
+                state = AR;
+            }
+            depth += 1;
+            break;
+        case Bd:
+        case Bf:
+        case Bm:
+        case Bn:
+        case Bs:
+        case Bt:
+        case Bz:
+            is_key = (state == OB) || (state == KE);
+            state = next_state == Bd   ? IN
+                    : next_state == Bf ? F1
+                    : next_state == Bm ? MI
+                    : next_state == Bn ? N1
+                    : next_state == Bs ? ST
+                    : next_state == Bt ? T1
+                                       : ZE;
+            break;
+        case Fa:
+        case Fo:
+            if (depth == 0 || in_object != (next_state == Fo)) {
+                // close without open, or mismatched close
+                return MU_JSON_ERR_BAD_FORMAT;
+            }
+            depth -= 1;
+            is_key = false;
+            state = OK;
+            break;
+        case Pd:
+            state = FR;
+            break;
+        case Px:
+            state = E1;
+            break;
+        // The remaining actions mirror select_state()
+        case Pl:
+            state = in_object && is_key ? VA : __;
+            break;
+        case Pm:
+            state = !in_object ? (depth > 0 ? VA : __) : (is_key ? __ : KE);
+            break;
+        case Ps:
+            state = in_object && is_key ? state : OK;
+            break;
+        case Pq:
+            state = in_object && is_key ? CO : OK;
+            break;
+        default:
+            return MU_JSON_ERR_BAD_FORMAT;
+        }
+        if (state == __) {
+            return MU_JSON_ERR_BAD_FORMAT;
+        }
+    }
+
+    if (depth != 0) {
+        return MU_JSON_ERR_INCOMPLETE;
+    } else if (state != OK) {
+        return MU_JSON_ERR_BAD_FORMAT;
+    } else {
+        return MU_JSON_ERR_NONE;
+    }
+}
+
+const char *mu_json_stats_action_name(int i) {
+    if (i >= 0 && i < MU_JSON_STATS_N_ACTIONS) {
+        return s_state_names[NR_STATES + 1 + i];
+    } else {
+        return NULL;
+    }
+}
+
+mu_str_t *mu_json_token_slice(mu_json_token_t *token) {
+    if (token == NULL) {
+        return NULL;
+    } else {
+        return &token->json;
+    }
+}
+
+mu_json_token_type_t mu_json_token_type(mu_json_token_t *token) {
+    if (token == NULL) {
+        return MU_JSON_TOKEN_TYPE_UNKNOWN;
+    } else {
+        return token->type;
+    }
+}
+
+int mu_json_token_depth(mu_json_token_t *token) {
+    if (token == NULL) {
+        return -1;
     } else {
         return token->depth;
     }
@@ -513,6 +1484,32 @@ bool mu_json_token_is_last(mu_json_token_t *token) {
     }
 }
 
+int mu_json_token_element_count(mu_json_token_t *token) {
+    if (token == NULL || !is_container(token)) {
+        return 0;
+    }
+    // Count the commas between the brackets at depth 0, outside strings
+    const uint8_t *buf = mu_str_buf(&token->json);
+    size_t end = mu_str_length(&token->json) - 1;
+    int state = SCAN_OUT;
+    int32_t depth = 0;
+    int commas = 0;
+    bool empty = true;
+    for (size_t pos = 1; pos < end; pos++) {
+        uint8_t ch = buf[pos];
+        if (state == SCAN_OUT && !s_scan_bytes[ch]) {
+            // the common case: no change of string state or depth
+            commas += depth == 0 && ch == ',';
+            empty = empty && (classify_char(ch) == C_SPACE ||
+                              classify_char(ch) == C_WHITE);
+        } else {
+            empty = false;
+            state = scan_byte(state, &depth, ch);
+        }
+    }
+    return empty ? 0 : commas + 1;
+}
+
 mu_json_token_t *mu_json_token_prev(mu_json_token_t *token) {
     if (token == NULL) {
         return NULL;
@@ -607,253 +1604,1229 @@ mu_json_token_t *mu_json_token_next_sibling(mu_json_token_t *token) {
     }
 }
 
-// *****************************************************************************
-// Private (static) code
+mu_json_soa_t *mu_json_soa_init(mu_json_soa_t *soa, int16_t *depths,
+                                uint8_t *types, uint8_t *flags,
+                                uint32_t *offsets, uint32_t *lengths,
+                                size_t max_tokens) {
+    soa->base = NULL;
+    soa->depths = depths;
+    soa->types = types;
+    soa->flags = flags;
+    soa->offsets = offsets;
+    soa->lengths = lengths;
+    soa->max_tokens = max_tokens;
+    soa->n_tokens = 0;
+    return soa;
+}
 
-static int parse(mu_json_token_t *token_store, size_t max_tokens,
-                 mu_str_t *json_input) {
-    parser_t parser;
-    parser.json = json_input;
-    parser.tokens = token_store;
-    parser.max_tokens = max_tokens;
-    parser.token_count = 0;
-    parser.depth = 0;
-    parser.char_pos = 0;
-    parser.state = GO;
-    parser.error = MU_JSON_ERR_NONE;
-
-    bool eos = false;
-    uint8_t ch;
-    int char_class;
-    int next_state;
+int mu_json_soa_from_tokens(mu_json_soa_t *soa, mu_json_token_t *tokens,
+                            int n_tokens) {
+    if (n_tokens < 0 || (size_t)n_tokens > soa->max_tokens) {
+        return MU_JSON_ERR_NO_TOKENS;
+    }
+    soa->n_tokens = 0;
+    if (n_tokens == 0) {
+        return 0;
+    }
+    // The root's slice spans every other token's.
+    const uint8_t *base = mu_str_buf(&tokens[0].json);
+    if (mu_str_length(&tokens[0].json) > UINT32_MAX) {
+        return MU_JSON_ERR_LIMIT;
+    }
+    for (int i = 0; i < n_tokens; i++) {
+        mu_json_token_t *token = &tokens[i];
+        soa->depths[i] = token->depth;
+        soa->types[i] = token->type;
+        soa->flags[i] = token->flags;
+        soa->offsets[i] = (uint32_t)(mu_str_buf(&token->json) - base);
+        soa->lengths[i] = (uint32_t)mu_str_length(&token->json);
+    }
+    soa->base = base;
+    soa->n_tokens = n_tokens;
+    return n_tokens;
+}
 
-    TRACE_PRINTF("\n==== parsing '%.*s'", (int)mu_str_length(json_input),
-                 mu_str_buf(json_input));
+mu_str_t *mu_json_soa_slice(mu_json_soa_t *soa, int i, mu_str_t *slice) {
+    if (i < 0 || (size_t)i >= soa->n_tokens) {
+        return NULL;
+    } else {
+        return mu_str_init(slice, &soa->base[soa->offsets[i]],
+                           soa->lengths[i]);
+    }
+}
 
-    while (!eos) {
-        if (parser.error != MU_JSON_ERR_NONE) {
-            // allocation or format error
-            break;
-        }
-        eos = !mu_str_get_byte(parser.json, parser.char_pos, &ch);
-        if (eos) {
-            // treat end of string like a space delimiter: it simplififes the
-            // endgame logic.
-            char_class = C_SPACE;
-        } else if ((char_class = classify_char(ch)) < 0) {
-            // illegal character in json_input
-            parser.error = MU_JSON_ERR_BAD_FORMAT;
-            TRACE_PRINTF("\n'%c': illegal character", ch);
-            break;
-        }
+int mu_json_soa_parent(mu_json_soa_t *soa, int i) {
+    if (i <= 0 || (size_t)i >= soa->n_tokens) {
+        return -1;
+    } else {
+        // the nearest preceding token that is shallower
+        return rfind_depth_at_most(soa->depths, i, soa->depths[i] - 1);
+    }
+}
 
-        next_state = lookup_state(parser.state, char_class);
+int mu_json_soa_child(mu_json_soa_t *soa, int i) {
+    if (i < 0 || (size_t)i + 1 >= soa->n_tokens) {
+        return -1;
+    } else if (soa->depths[i + 1] > soa->depths[i]) {
+        return i + 1;
+    } else {
+        return -1;
+    }
+}
 
-        TRACE_PRINTF("\n%d %d '%c': %s %s => %s", parser.token_count,
-                     parser.depth, ch, ch_class_name(char_class),
-                     state_name(parser.state), state_name(next_state));
+int mu_json_soa_prev_sibling(mu_json_soa_t *soa, int i) {
+    if (i <= 0 || (size_t)i >= soa->n_tokens) {
+        return -1;
+    }
+    int depth = soa->depths[i];
+    int prev = rfind_depth_at_most(soa->depths, i, depth);
+    if (prev >= 0 && soa->depths[prev] == depth) {
+        return prev;
+    } else {
+        return -1; // reached the parent first
+    }
+}
 
-        if (next_state >= 0 && next_state < NR_STATES) {
-            // Simple state transition w/o special action
-            set_state(&parser, next_state);
+int mu_json_soa_next_sibling(mu_json_soa_t *soa, int i) {
+    if (i < 0 || (size_t)i >= soa->n_tokens) {
+        return -1;
+    }
+    int depth = soa->depths[i];
+    size_t next = find_depth_at_most(soa->depths, i + 1, soa->n_tokens, depth);
+    if (next < soa->n_tokens && soa->depths[next] == depth) {
+        return (int)next;
+    } else {
+        return -1; // reached the end of the parent first
+    }
+}
 
-        } else {
-            // These states perform an action before transitioning to next state
-            switch (next_state) {
-
-            // These actions cause tokens to be allocated.
-            case Ba: {
-                // [ - Begin Array
-                std_alloc(&parser, MU_JSON_TOKEN_TYPE_ARRAY, AR);
-                parser.depth += 1;
-                break;
-            }
+mu_json_doc_t *mu_json_doc_init(mu_json_doc_t *doc,
+                                mu_json_token_t *token_store,
+                                size_t max_tokens) {
+    doc->tokens = token_store;
+    doc->max_tokens = max_tokens;
+    doc->n_tokens = 0;
+    doc->error = MU_JSON_ERR_NONE;
+    doc->base = NULL;
+    doc->length = 0;
+    doc->index = NULL;
+    doc->stats = NULL;
+    return doc;
+}
 
-            case Bd: {
-                // Begin digit 1..9
-                std_alloc(&parser, MU_JSON_TOKEN_TYPE_INTEGER, IN);
-                break;
-            }
+int mu_json_doc_parse(mu_json_doc_t *doc, const uint8_t *buf, size_t buflen,
+                      void *arg) {
+    mu_json_parse_opts_t *opts = (mu_json_parse_opts_t *)arg;
+    int result =
+        mu_json_parse_buffer(doc->tokens, doc->max_tokens, buf, buflen, arg);
+
+    doc->base = buf;
+    doc->length = buflen;
+    doc->index = NULL;
+    doc->stats = opts ? opts->stats : NULL;
+    if (result < 0) {
+        doc->n_tokens = 0;
+        doc->error = (mu_json_err_t)result;
+    } else {
+        doc->n_tokens = result;
+        doc->error = MU_JSON_ERR_NONE;
+    }
+    return result;
+}
 
-            case Bf: {
-                // Begin false
-                std_alloc(&parser, MU_JSON_TOKEN_TYPE_FALSE, F1);
-                break;
-            }
+int mu_json_doc_attach_index(mu_json_doc_t *doc, mu_json_soa_t *index) {
+    int result = mu_json_soa_from_tokens(index, doc->tokens, doc->n_tokens);
+    doc->index = result < 0 ? NULL : index;
+    return result;
+}
 
-            case Bm: {
-                // Begin minus
-                std_alloc(&parser, MU_JSON_TOKEN_TYPE_INTEGER, MI);
-                break;
-            }
+int mu_json_doc_token_count(mu_json_doc_t *doc) {
+    return doc->n_tokens;
+}
 
-            case Bn: {
-                // begin null
-                std_alloc(&parser, MU_JSON_TOKEN_TYPE_NULL, N1);
-                break;
-            }
+mu_json_err_t mu_json_doc_error(mu_json_doc_t *doc) {
+    return doc->error;
+}
 
-            case Bo: {
-                // begin object
-                std_alloc(&parser, MU_JSON_TOKEN_TYPE_OBJECT, OB);
-                parser.depth += 1;
-                break;
-            }
+mu_json_token_t *mu_json_doc_root(mu_json_doc_t *doc) {
+    return mu_json_doc_token(doc, 0);
+}
 
-            case Bs: {
-                // begin string
-                std_alloc(&parser, MU_JSON_TOKEN_TYPE_STRING, ST);
-                break;
-            }
+mu_json_token_t *mu_json_doc_token(mu_json_doc_t *doc, int i) {
+    if (i < 0 || i >= doc->n_tokens) {
+        return NULL;
+    } else {
+        return &doc->tokens[i];
+    }
+}
 
-            case Bt: {
-                // begin true
-                std_alloc(&parser, MU_JSON_TOKEN_TYPE_TRUE, T1);
-                break;
-            }
+int mu_json_doc_index_of(mu_json_doc_t *doc, mu_json_token_t *token) {
+    if (token < doc->tokens || token >= &doc->tokens[doc->n_tokens]) {
+        return -1;
+    } else {
+        return (int)(token - doc->tokens);
+    }
+}
 
-            case Bz: {
-                // Begin zero
-                std_alloc(&parser, MU_JSON_TOKEN_TYPE_INTEGER, ZE);
-                break;
-            }
+int mu_json_doc_offset_of(mu_json_doc_t *doc, mu_json_token_t *token) {
+    if (mu_json_doc_index_of(doc, token) < 0) {
+        return -1;
+    } else {
+        return (int)(mu_str_buf(&token->json) - doc->base);
+    }
+}
 
-            // These actions cause tokens to be finished and/or state change.
-            case Fa: {
-                // ] (finish array)
-                mu_json_token_t *token = tos(&parser);
-                if (mu_json_token_type(token) != MU_JSON_TOKEN_TYPE_ARRAY) {
-                    // TOS is not an object.  Close TOS and container.
-                    finish_token(&parser, token, false);
-                    mu_json_token_t *container = mu_json_token_parent(token);
-                    finish_token(&parser, container, true);                    
-                } else if (token_is_sealed(token)) {
-                    // TOS is an object that's already been sealed.  Finish
-                    // container.
-                    mu_json_token_t *container = mu_json_token_parent(token);
-                    finish_token(&parser, container, true);                    
-                } else {
-                    // TOS is an empty object.  Finish it.
-                    finish_token(&parser, token, true);
-                }
-                parser.depth -= 1;
-                set_state(&parser, OK);
-                break;
-            }
+mu_json_token_t *mu_json_doc_parent(mu_json_doc_t *doc,
+                                    mu_json_token_t *token) {
+    int i = mu_json_doc_index_of(doc, token);
+    if (i < 0) {
+        return NULL;
+    } else if (doc->index) {
+        return mu_json_doc_token(doc, mu_json_soa_parent(doc->index, i));
+    } else {
+        return mu_json_token_parent(token);
+    }
+}
 
-            case Fo: {
-                // } (finish object)
-                mu_json_token_t *token = tos(&parser);
-                if (mu_json_token_type(token) != MU_JSON_TOKEN_TYPE_OBJECT) {
-                    // TOS is not an object.  Close TOS and container.
-                    finish_token(&parser, token, false);
-                    mu_json_token_t *container = mu_json_token_parent(token);
-                    finish_token(&parser, container, true);                    
-                } else if (token_is_sealed(token)) {
-                    // TOS is an object that's already been sealed.  Finish
-                    // container.
-                    mu_json_token_t *container = mu_json_token_parent(token);
-                    finish_token(&parser, container, true);                    
-                } else {
-                    // TOS is an empty object.  Finish it.
-                    finish_token(&parser, token, true);
-                }
-                parser.depth -= 1;
-                set_state(&parser, OK);
-                break;
-            }
+mu_json_token_t *mu_json_doc_child(mu_json_doc_t *doc,
+                                   mu_json_token_t *token) {
+    int i = mu_json_doc_index_of(doc, token);
+    if (i < 0 || i + 1 >= doc->n_tokens) {
+        return NULL;
+    } else if (token[1].depth > token->depth) {
+        return &token[1]; // a child always follows its parent directly
+    } else {
+        return NULL;
+    }
+}
 
-            case Pd: {
-                // Process decimal point: convert INTEGER to NUMBER
-                mu_json_token_t *token = tos(&parser);
-                token->type = MU_JSON_TOKEN_TYPE_NUMBER;
-                set_state(&parser, FR);
-                break;
-            }
+mu_json_token_t *mu_json_doc_prev_sibling(mu_json_doc_t *doc,
+                                          mu_json_token_t *token) {
+    int i = mu_json_doc_index_of(doc, token);
+    if (i < 0) {
+        return NULL;
+    } else if (doc->index) {
+        return mu_json_doc_token(doc, mu_json_soa_prev_sibling(doc->index, i));
+    } else {
+        return mu_json_token_prev_sibling(token);
+    }
+}
 
-            case Pl: {
-                // Process colon
-                mu_json_token_t *token = tos(&parser);
-                finish_token(&parser, token, false);
-                set_state(&parser, select_state(token, __, __, __, VA));
-                break;
-            }
+mu_json_token_t *mu_json_doc_next_sibling(mu_json_doc_t *doc,
+                                          mu_json_token_t *token) {
+    int i = mu_json_doc_index_of(doc, token);
+    if (i < 0) {
+        return NULL;
+    } else if (doc->index) {
+        return mu_json_doc_token(doc, mu_json_soa_next_sibling(doc->index, i));
+    } else {
+        return mu_json_token_next_sibling(token);
+    }
+}
 
-            case Pm: {
-                // Process comma
-                mu_json_token_t *token = tos(&parser);
-                finish_token(&parser, token, false);
-                set_state(&parser, select_state(token, __, VA, KE, __));
-                break;
-            }
+int mu_json_array_to_doubles(mu_json_token_t *array, double *out,
+                             size_t max_out) {
+    return tokens_to_numbers(array, out, max_out, NUMBERS_DOUBLE);
+}
 
-            case Ps: {
-                // process trailing space
-                mu_json_token_t *token = tos(&parser);
-                if (!is_container(token)) {
-                    finish_token(&parser, token, false);
-                }
-                set_state(&parser,
-                          select_state(token, OK, OK, OK, parser.state));
-                break;
-            }
+int mu_json_array_to_float(mu_json_token_t *array, float *out,
+                           size_t max_out) {
+    return tokens_to_numbers(array, out, max_out, NUMBERS_FLOAT);
+}
 
-            case Pq: {
-                // Process closing quote:
-                mu_json_token_t *token = tos(&parser);
-                finish_token(&parser, token, true);
-                set_state(&parser, select_state(token, OK, OK, OK, CO));
-                break;
-            }
+int mu_json_array_to_int32(mu_json_token_t *array, int32_t *out,
+                           size_t max_out) {
+    return tokens_to_numbers(array, out, max_out, NUMBERS_INT32);
+}
 
-            case Px: {
-                // Process exponent: convert INTEGER to NUMBER
-                mu_json_token_t *token = tos(&parser);
-                token->type = MU_JSON_TOKEN_TYPE_NUMBER;
-                set_state(&parser, E1);
-                break;
-            }
+int mu_json_buffer_to_doubles(const uint8_t *buf, size_t buflen, double *out,
+                              size_t max_out) {
+    return buffer_to_numbers(buf, buflen, out, max_out, NUMBERS_DOUBLE);
+}
 
-            default: {
-                // Bad action.
-                parser.error = MU_JSON_ERR_BAD_FORMAT;
-                break;
-            }
+int mu_json_buffer_to_float(const uint8_t *buf, size_t buflen, float *out,
+                            size_t max_out) {
+    return buffer_to_numbers(buf, buflen, out, max_out, NUMBERS_FLOAT);
+}
 
-            } // switch(next_state)
-        }
+int mu_json_buffer_to_int32(const uint8_t *buf, size_t buflen, int32_t *out,
+                            size_t max_out) {
+    return buffer_to_numbers(buf, buflen, out, max_out, NUMBERS_INT32);
+}
 
-        // advance to next char
-        parser.char_pos += 1;
-    } // while(true)
+mu_json_extractor_t *mu_json_extractor_init(mu_json_extractor_t *extractor,
+                                            mu_json_column_t *columns,
+                                            size_t n_columns,
+                                            size_t max_rows) {
+    extractor->columns = columns;
+    extractor->n_columns = n_columns;
+    extractor->max_rows = max_rows;
+    extractor->key_searches = 0;
+    for (size_t i = 0; i < n_columns; i++) {
+        columns[i].key_length = strlen(columns[i].key);
+    }
+    return extractor;
+}
 
-    TRACE_PRINTF("\n=== endgame: depth=%d, state=%s, err=%d\n", parser.depth,
-                 state_name(parser.state), parser.error);
+int mu_json_extract_columns(mu_json_extractor_t *extractor,
+                            mu_json_token_t *array) {
+    key_prediction_t predicted[MU_JSON_EXTRACT_MAX_KEYS] = {0};
+    size_t row = 0;
 
-    int retval;
+    extractor->key_searches = 0;
+    if (array == NULL || array->type != MU_JSON_TOKEN_TYPE_ARRAY) {
+        return MU_JSON_ERR_BAD_FORMAT;
+    }
+    for (mu_json_token_t *record = mu_json_token_child(array); record != NULL;
+         record = mu_json_token_next_sibling(record), row++) {
+        if (record->type != MU_JSON_TOKEN_TYPE_OBJECT) {
+            return MU_JSON_ERR_BAD_FORMAT;
+        } else if (row == extractor->max_rows) {
+            return MU_JSON_ERR_LIMIT;
+        }
+        for (size_t i = 0; i < extractor->n_columns; i++) {
+            store_column(&extractor->columns[i], row, NULL); // not yet seen
+        }
+        int position = 0;
+        mu_json_token_t *key = mu_json_token_child(record);
+        while (key != NULL) {
+            mu_json_token_t *value = key + 1; // always follows its key
+            int i = find_column(extractor, predicted, position++, &key->json);
+            if (i >= 0) {
+                store_column(&extractor->columns[i], row, value);
+            }
+            key = mu_json_token_next_sibling(value);
+        }
+    }
+    return (int)row;
+}
 
-    if (parser.error != MU_JSON_ERR_NONE) {
+bool mu_json_column_is_valid(mu_json_column_t *column, size_t row) {
+    return column->valid && (column->valid[row / 8] & (1 << (row % 8)));
+}
+
+mu_json_err_t mu_json_projection_init(mu_json_projection_t *projection,
+                                      const char *const *pointers,
+                                      size_t n_pointers) {
+    memset(projection, 0, sizeof(mu_json_projection_t));
+    if (n_pointers > MU_JSON_PROJECT_MAX_POINTERS) {
+        return MU_JSON_ERR_LIMIT;
+    }
+    for (size_t p = 0; p < n_pointers; p++) {
+        const char *s = pointers[p];
+        int n_segments = 0;
+        while (*s != '\0') {
+            if (*s != '/') {
+                return MU_JSON_ERR_BAD_FORMAT;
+            } else if (n_segments == MU_JSON_PROJECT_MAX_SEGMENTS) {
+                return MU_JSON_ERR_LIMIT;
+            }
+            mu_json_pointer_segment_t *segment =
+                &projection->segments[n_segments++][p];
+            segment->key = ++s;
+            while (*s != '\0' && *s != '/') {
+                if (*s == '~' && s[1] != '0' && s[1] != '1') {
+                    return MU_JSON_ERR_BAD_FORMAT;
+                }
+                s += *s == '~' ? 2 : 1;
+            }
+            segment->length = s - segment->key;
+            // an array index is 0 or digits without a leading zero
+            segment->index = -1;
+            if (segment->length > 0 && segment->length < 10 &&
+                (segment->key[0] != '0' || segment->length == 1)) {
+                segment->index = 0;
+                for (size_t i = 0; i < segment->length; i++) {
+                    if (!is_digit(segment->key[i])) {
+                        segment->index = -1;
+                        break;
+                    }
+                    segment->index = segment->index * 10 + segment->key[i] -
+                                     '0';
+                }
+            }
+        }
+        projection->complete[n_segments] |= 1u << p;
+        projection->all |= 1u << p;
+    }
+    return MU_JSON_ERR_NONE;
+}
+
+int mu_json_compact(mu_json_token_t *tokens, int n_tokens,
+                    mu_json_token_predicate_t keep, void *arg) {
+    int kept = 0;
+
+    // Mark first, so that `keep` sees the document intact...
+    for (int i = 0; i < n_tokens;) {
+        mu_json_token_t *token = &tokens[i];
+        if (is_object_key(token)) {
+            i += 1; // decided along with its value
+        } else if (keep(token, arg)) {
+            i += 1;
+        } else {
+            token->flags |= TOKEN_FLAG_REMOVED;
+            if (i > 0 && is_object_key(token - 1)) {
+                token[-1].flags |= TOKEN_FLAG_REMOVED;
+            }
+            i = subtree_end(tokens, n_tokens, i);
+        }
+    }
+    // ...then move the survivors down.
+    for (int i = 0; i < n_tokens;) {
+        if (tokens[i].flags & TOKEN_FLAG_REMOVED) {
+            tokens[i].flags &= ~TOKEN_FLAG_REMOVED;
+            i = subtree_end(tokens, n_tokens, i);
+        } else {
+            tokens[kept] = tokens[i++];
+            tokens[kept++].flags &=
+                ~(MU_JSON_TOKEN_FLAG_IS_FIRST | MU_JSON_TOKEN_FLAG_IS_LAST);
+        }
+    }
+    if (kept > 0) {
+        set_is_first(&tokens[0]);
+        set_is_last(&tokens[kept - 1]);
+    }
+    return kept;
+}
+
+int mu_json_compact_copy(mu_json_token_t *tokens, int n_tokens, uint8_t *buf,
+                         size_t buflen) {
+    size_t length = copy_tokens(tokens, n_tokens, NULL);
+    if (buf == NULL) {
+        return (int)length;
+    } else if (length > buflen) {
+        return MU_JSON_ERR_LIMIT;
+    }
+    return (int)copy_tokens(tokens, n_tokens, buf);
+}
+
+mu_json_array_index_t *mu_json_array_index_init(mu_json_array_index_t *index,
+                                                int32_t *entries,
+                                                size_t max_entries) {
+    index->array = NULL;
+    index->entries = entries;
+    index->max_entries = max_entries;
+    index->n_entries = 0;
+    index->n_elements = 0;
+    index->shift = 0;
+    return index;
+}
+
+int mu_json_array_index_build(mu_json_array_index_t *index,
+                              mu_json_token_t *array) {
+    index->array = NULL;
+    index->n_entries = 0;
+    index->n_elements = 0;
+    index->shift = 0;
+    if (array == NULL || array->type != MU_JSON_TOKEN_TYPE_ARRAY ||
+        (array->flags & MU_JSON_TOKEN_FLAG_IS_SPARSE)) {
+        return MU_JSON_ERR_BAD_FORMAT;
+    }
+    int depth = array->depth + 1;
+    for (mu_json_token_t *t = mu_json_token_next(array);
+         t != NULL && t->depth >= depth; t = mu_json_token_next(t)) {
+        if (t->depth > depth) {
+            continue;
+        }
+        int element = index->n_elements++;
+        if (element & ((1 << index->shift) - 1)) {
+            continue;
+        } else if (index->n_entries == index->max_entries) {
+            if (index->max_entries == 0) {
+                continue;
+            }
+            // out of room: keep every other entry, and record half as often
+            for (size_t k = 0; 2 * k < index->n_entries; k++) {
+                index->entries[k] = index->entries[2 * k];
+            }
+            index->n_entries = (index->n_entries + 1) / 2;
+            index->shift += 1;
+            if (element & ((1 << index->shift) - 1)) {
+                continue;
+            }
+        }
+        index->entries[index->n_entries++] = (int32_t)(t - array);
+    }
+    index->array = array;
+    return index->n_elements;
+}
+
+mu_json_token_t *mu_json_array_index_get(mu_json_array_index_t *index,
+                                         mu_json_token_t *array, int i) {
+    if (index->array != array &&
+        mu_json_array_index_build(index, array) < 0) {
+        return NULL;
+    } else if (i < 0 || i >= index->n_elements) {
+        return NULL;
+    }
+    size_t k = (size_t)i >> index->shift;
+    mu_json_token_t *element;
+    if (k < index->n_entries) {
+        element = &array[index->entries[k]];
+        i -= (int)(k << index->shift);
+    } else {
+        element = mu_json_token_child(array); // no entries at all
+    }
+    while (i-- > 0) {
+        element = mu_json_token_next_sibling(element);
+    }
+    return element;
+}
+
+mu_json_err_t mu_json_path_compile(mu_json_path_t *path, const char *expr) {
+    const char *p = expr;
+    mu_json_err_t err = MU_JSON_ERR_NONE;
+
+    path->n_steps = 0;
+    if (*p++ != '$') {
+        return MU_JSON_ERR_BAD_FORMAT;
+    }
+    while (err == MU_JSON_ERR_NONE && *p != '\0') {
+        if (path->n_steps == MU_JSON_PATH_MAX_STEPS) {
+            return MU_JSON_ERR_LIMIT;
+        }
+        mu_json_path_step_t *step = &path->steps[path->n_steps++];
+        memset(step, 0, sizeof(mu_json_path_step_t));
+        if (p[0] == '.' && p[1] == '.') {
+            p += 2;
+            step->op = MU_JSON_PATH_OP_DESCENDANT;
+            err = compile_name(&p, &step->name);
+        } else if (p[0] == '.') {
+            p += 1;
+            err = compile_name(&p, &step->name);
+            step->op = step->name.name ? MU_JSON_PATH_OP_CHILD
+                                       : MU_JSON_PATH_OP_WILDCARD;
+        } else if (p[0] == '[') {
+            p += 1;
+            err = compile_bracket(&p, step);
+        } else {
+            err = MU_JSON_ERR_BAD_FORMAT;
+        }
+    }
+    return err;
+}
+
+int mu_json_path_eval(const mu_json_path_t *path, mu_json_token_t *root,
+                      mu_json_path_callback_t callback, void *arg) {
+    path_eval_t eval = {.path = path, .callback = callback, .arg = arg};
+    if (root != NULL) {
+        eval_step(&eval, 0, root);
+    }
+    return eval.matches;
+}
+
+mu_json_err_t mu_json_filter_init(mu_json_filter_t *filter,
+                                  const mu_json_filter_predicate_t *predicates,
+                                  size_t n_predicates, mu_json_token_t *tokens,
+                                  size_t max_tokens) {
+    const char *pointers[MU_JSON_PROJECT_MAX_POINTERS];
+    mu_json_projection_t *projection = &filter->projection;
+
+    filter->predicates = predicates;
+    filter->n_predicates = n_predicates;
+    filter->projected = true;
+    filter->n_needles = 0;
+    filter->tokens = tokens;
+    filter->max_tokens = max_tokens;
+    filter->parsed = 0;
+    filter->failed = 0;
+    filter->no_tokens = 0;
+    if (n_predicates > MU_JSON_PROJECT_MAX_POINTERS) {
+        return MU_JSON_ERR_LIMIT;
+    }
+    for (size_t p = 0; p < n_predicates; p++) {
+        if (predicates[p].op == MU_JSON_FILTER_EQUALS &&
+            predicates[p].value == NULL) {
+            return MU_JSON_ERR_BAD_FORMAT;
+        }
+        pointers[p] = predicates[p].pointer;
+    }
+    mu_json_err_t err =
+        mu_json_projection_init(projection, pointers, n_predicates);
+    if (err != MU_JSON_ERR_NONE) {
+        return err;
+    }
+    for (int n = 0; n <= MU_JSON_PROJECT_MAX_SEGMENTS; n++) {
+        for (size_t p = 0; p < n_predicates; p++) {
+            if (projection->complete[n] & (1u << p)) {
+                filter->n_segments[p] = n;
+            }
+        }
+    }
+    for (size_t p = 0; p < n_predicates; p++) {
+        int n = filter->n_segments[p];
+        for (int i = 0; i < n; i++) {
+            if (projection->segments[i][p].index >= 0) {
+                filter->projected = false;
+            }
+        }
+        // A match contains its field's key, unless the key is escaped or the
+        // field is an array element...
+        if (n > 0) {
+            const mu_json_pointer_segment_t *last =
+                &projection->segments[n - 1][p];
+            if (last->index < 0 &&
+                memchr(last->key, '~', last->length) == NULL) {
+                mu_str_init(&filter->needles[filter->n_needles++],
+                            (const uint8_t *)last->key, last->length);
+            }
+        }
+        // ...and the text it must equal.
+        if (predicates[p].op == MU_JSON_FILTER_EQUALS) {
+            mu_str_init(&filter->needles[filter->n_needles++],
+                        (const uint8_t *)predicates[p].value,
+                        strlen(predicates[p].value));
+        }
+    }
+    // The longest needle is likely the rarest: search for it first.
+    for (size_t i = 1; i < filter->n_needles; i++) {
+        if (mu_str_length(&filter->needles[i]) >
+            mu_str_length(&filter->needles[0])) {
+            mu_str_t needle = filter->needles[0];
+            filter->needles[0] = filter->needles[i];
+            filter->needles[i] = needle;
+        }
+    }
+    return MU_JSON_ERR_NONE;
+}
+
+bool mu_json_filter_match(mu_json_filter_t *filter, const uint8_t *record,
+                          size_t length) {
+    mu_str_t str;
+
+    mu_str_init(&str, record, length);
+    for (size_t i = 0; i < filter->n_needles; i++) {
+        if (mu_str_find_substr(&str, &filter->needles[i]) ==
+            MU_STR_NOT_FOUND) {
+            return false;
+        }
+    }
+    return filter_record(filter, record, length);
+}
+
+int mu_json_filter_ndjson(mu_json_filter_t *filter, const uint8_t *buf,
+                          size_t buflen, mu_json_filter_callback_t callback,
+                          void *arg) {
+    int matches = 0;
+    size_t from = 0; // start of the next line not yet considered
+    mu_str_t rest;
+
+    while (from < buflen) {
+        size_t start = from; // the line to consider...
+        size_t pos = from;   // ...which includes this byte
+        if (filter->n_needles > 0) {
+            mu_str_init(&rest, &buf[from], buflen - from);
+            size_t at = mu_str_find_substr(&rest, &filter->needles[0]);
+            if (at == MU_STR_NOT_FOUND) {
+                break; // no more lines can match
+            }
+            pos = from + at;
+            mu_str_init(&rest, &buf[from], at);
+            size_t nl = mu_str_rfind_byte(&rest, '\n');
+            start = nl == MU_STR_NOT_FOUND ? from : from + nl + 1;
+        }
+        mu_str_init(&rest, &buf[pos], buflen - pos);
+        size_t nl = mu_str_find_byte(&rest, '\n');
+        size_t end = nl == MU_STR_NOT_FOUND ? buflen : pos + nl;
+        from = end + 1;
+        if (end > start && buf[end - 1] == '\r') {
+            end -= 1;
+        }
+        if (mu_json_filter_match(filter, &buf[start], end - start)) {
+            matches += 1;
+            mu_str_t record;
+            mu_str_init(&record, &buf[start], end - start);
+            if (callback && !callback(&record, arg)) {
+                break;
+            }
+        }
+    }
+    return matches;
+}
+
+// *****************************************************************************
+// Private (static) code
+
+static int parse(mu_json_token_t *token_store, size_t max_tokens,
+                 mu_str_t *json_input, mu_json_parse_opts_t *opts,
+                 input_kind_t input) {
+    parser_t parser;
+    if (!parser_init(&parser, token_store, max_tokens, json_input, opts,
+                     input)) {
+        return parser_finish(&parser, opts);
+    }
+
+    parser_run(&parser);
+    return parser_finish(&parser, opts);
+}
+
+static void parser_run(parser_t *parser) {
+#ifdef USE_COMPUTED_GOTO
+    // Jump targets indexed by the next state.  The threaded loop below never
+    // dispatches NR_STATES or __, but they resume the general path regardless.
+    static const void *const s_dispatch[256] = {
+        [0 ... NR_STATES - 1] = &&L_transition,
+        [NR_STATES] = &&L_general,
+        [Ba] = &&L_Ba,
+        [Bd] = &&L_Bd,
+        [Bf] = &&L_Bf,
+        [Bm] = &&L_Bm,
+        [Bn] = &&L_Bn,
+        [Bo] = &&L_Bo,
+        [Bs] = &&L_Bs,
+        [Bt] = &&L_Bt,
+        [Bz] = &&L_Bz,
+        [Fa] = &&L_Fa,
+        [Fo] = &&L_Fo,
+        [Pd] = &&L_Pd,
+        [Pl] = &&L_Pl,
+        [Pm] = &&L_Pm,
+        [Ps] = &&L_Ps,
+        [Pq] = &&L_Pq,
+        [Px] = &&L_Px,
+        [Px + 1 ... 255] = &&L_general,
+    };
+    int next_state;
+
+    while (parser_step(parser)) {
+        // Direct threading: fetch, classify and dispatch characters right
+        // here.  Strings, end of input, NUL and illegal chars take the general
+        // path through parser_step().
+    L_fast:
+        if (parser->state != ST &&
+            (size_t)parser->char_pos < parser->json->length &&
+            (size_t)parser->char_pos < parser->string_limit_pos) {
+            uint8_t ch = parser->json->buf[parser->char_pos];
+            if ((next_state = lookup_byte(parser->state, ch)) != __) {
+                parser->prev_state = parser->state;
+                TRACE_PRINTF("\n%d %d '%c': %s => %s", parser->token_count,
+                             parser->depth, ch, state_name(parser->state),
+                             state_name(next_state));
+                goto *s_dispatch[next_state];
+            }
+        }
+    L_general:
+        continue;
+
+    L_transition:
+        // Simple state transition w/o special action
+        STATS_ADD(parser, transitions, 1);
+        set_state(parser, next_state);
+        parser->char_pos += 1;
+        goto L_fast;
+
+        // One label per action, each with its own copy of the action code
+#define THREADED_ACTION(_action)                                               \
+    L_##_action : perform_action(parser, _action);                            \
+    goto L_acted;
+        THREADED_ACTION(Ba)
+        THREADED_ACTION(Bd)
+        THREADED_ACTION(Bf)
+        THREADED_ACTION(Bm)
+        THREADED_ACTION(Bn)
+        THREADED_ACTION(Bo)
+        THREADED_ACTION(Bs)
+        THREADED_ACTION(Bt)
+        THREADED_ACTION(Bz)
+        THREADED_ACTION(Fa)
+        THREADED_ACTION(Fo)
+        THREADED_ACTION(Pd)
+        THREADED_ACTION(Pl)
+        THREADED_ACTION(Pm)
+        THREADED_ACTION(Ps)
+        THREADED_ACTION(Pq)
+        THREADED_ACTION(Px)
+#undef THREADED_ACTION
+
+    L_acted:
+        if (parser->error != MU_JSON_ERR_NONE) {
+            break;
+        }
+        parser->char_pos += 1;
+        goto L_fast;
+    }
+#else
+    while (parser_step(parser)) {
+    }
+#endif
+}
+
+static bool parser_init(parser_t *parser, mu_json_token_t *tokens,
+                        size_t max_tokens, mu_str_t *json_input,
+                        mu_json_parse_opts_t *opts, input_kind_t input) {
+    bool nul_terminated = input == INPUT_NUL_TERMINATED;
+    parser->json = json_input;
+    parser->tokens = tokens;
+    parser->max_tokens = max_tokens;
+    parser->token_count = 0;
+    parser->depth = 0;
+    parser->char_pos = 0;
+    parser->state = GO;
+    parser->container = -1;
+    parser->is_key = false;
+    parser->error = MU_JSON_ERR_NONE;
+    parser->stats = opts ? opts->stats : NULL;
+    parser->values = opts ? opts->values : NULL;
+    parser->sparse_limit = opts && opts->sparse_arrays
+                               ? opts->sparse_array_tokens
+                               : SIZE_MAX;
+    parser->eliding = false;
+    parser->projection = opts ? opts->projection : NULL;
+    parser->skip_depth = INT_MAX;
+    parser->keep_depth = INT_MAX;
+    parser->key_mask = 0;
+    parser->max_depth = MU_JSON_MAX_DEPTH;
+    parser->max_string = 0;
+    parser->string_limit_pos = SIZE_MAX;
+    parser->nul_terminated = nul_terminated;
+    parser->prev_state = GO;
+    if (input == INPUT_PADDED) {
+        parser->readable = mu_str_length(json_input) + MU_JSON_PADDING;
+    } else if (input == INPUT_SIZED) {
+        parser->readable = mu_str_length(json_input);
+    } else {
+        // a word load could run past the NUL into unmapped memory
+        parser->readable = 0;
+    }
+    if (opts) {
+        if (opts->max_depth > 0 && opts->max_depth < MU_JSON_MAX_DEPTH) {
+            parser->max_depth = opts->max_depth;
+        }
+        parser->max_string = opts->max_string_length;
+        if (nul_terminated && opts->max_bytes > 0 &&
+            opts->max_bytes < INT_MAX) {
+            // length is not yet known: stop scanning one byte past the limit
+            mu_str_init(json_input, mu_str_buf(json_input),
+                        opts->max_bytes + 1);
+        } else if (opts->max_bytes > 0 &&
+                   mu_str_length(json_input) > opts->max_bytes) {
+            // reject oversized documents before scanning them
+            parser->char_pos = opts->max_bytes;
+            parser->error = MU_JSON_ERR_LIMIT;
+        }
+    }
+    if (opts && opts->error) {
+        memset(opts->error, 0, sizeof(mu_json_error_info_t));
+        opts->error->container = -1;
+    }
+
+    TRACE_PRINTF("\n==== parsing '%.*s'", (int)mu_str_length(json_input),
+                 mu_str_buf(json_input));
+
+    // An oversized document (see max_bytes) is rejected without scanning it.
+    return parser->error == MU_JSON_ERR_NONE;
+}
+
+static ALWAYS_INLINE bool parser_step(parser_t *parser) {
+    uint8_t ch;
+    int char_class;
+    bool eos;
+
+    parser->prev_state = parser->state;
+    if (parser->state == ST) {
+        // Fast path: skip the body of a string without table lookups.
+        size_t end = mu_str_length(parser->json);
+        if (end > parser->string_limit_pos) {
+            end = parser->string_limit_pos;
+        }
+        size_t pos = skip_string_body(mu_str_buf(parser->json),
+                                      parser->char_pos, end, parser->readable);
+        STATS_ADD(parser, transitions, pos - parser->char_pos);
+        parser->char_pos = pos;
+    }
+    if ((size_t)parser->char_pos >= parser->string_limit_pos) {
+        // current string exceeds max_string_length
+        parser->error = MU_JSON_ERR_LIMIT;
+        return false;
+    }
+    eos = !mu_str_get_byte(parser->json, parser->char_pos, &ch);
+    if (eos && parser->nul_terminated) {
+        // C string ran past max_bytes without a NUL
+        parser->nul_terminated = false;
+        parser->char_pos -= 1;
+        parser->error = MU_JSON_ERR_LIMIT;
+        return false;
+    } else if (eos) {
+        // treat end of string like a space delimiter: it simplififes the
+        // endgame logic.
+        char_class = C_SPACE;
+    } else if ((char_class = classify_char(ch)) == __) {
+        if (ch == '\0' && parser->nul_terminated) {
+            // NUL ends a C string input: NUL is classed as illegal, so this
+            // costs nothing on the common path.  Now that the length is known,
+            // later slices to MU_STR_END are well defined.
+            mu_str_init(parser->json, mu_str_buf(parser->json),
+                        parser->char_pos);
+            parser->nul_terminated = false;
+            eos = true;
+            char_class = C_SPACE;
+        } else {
+            // illegal character in json_input
+            parser->error = MU_JSON_ERR_BAD_FORMAT;
+            TRACE_PRINTF("\n'%c': illegal character", ch);
+            return false;
+        }
+    }
+
+    int next_state = lookup_state(parser->state, char_class);
+
+    TRACE_PRINTF("\n%d %d '%c': %s %s => %s", parser->token_count,
+                 parser->depth, ch, ch_class_name(char_class),
+                 state_name(parser->state), state_name(next_state));
+
+    if (next_state >= 0 && next_state < NR_STATES) {
+        // Simple state transition w/o special action
+        STATS_ADD(parser, transitions, 1);
+        set_state(parser, next_state);
+    } else {
+        // These states perform an action before transitioning to next state
+        perform_action(parser, next_state);
+    }
+
+    if (parser->error != MU_JSON_ERR_NONE) {
+        // allocation or format error
+        return false;
+    }
+    // advance to next char
+    parser->char_pos += 1;
+    return !eos;
+}
+
+static ALWAYS_INLINE void perform_action(parser_t *parser, int action) {
+    switch (action) {
+
+    // These actions cause tokens to be allocated.
+    ACTION(Ba) {
+        // [ - Begin Array
+        std_alloc(parser, MU_JSON_TOKEN_TYPE_ARRAY, AR);
+        push_container(parser);
+        break;
+    }
+
+    ACTION(Bd) {
+        // Begin digit 1..9
+        std_alloc(parser, MU_JSON_TOKEN_TYPE_INTEGER, IN);
+        break;
+    }
+
+    ACTION(Bf) {
+        // Begin false
+        std_alloc(parser, MU_JSON_TOKEN_TYPE_FALSE, F1);
+        break;
+    }
+
+    ACTION(Bm) {
+        // Begin minus
+        std_alloc(parser, MU_JSON_TOKEN_TYPE_INTEGER, MI);
+        break;
+    }
+
+    ACTION(Bn) {
+        // begin null
+        std_alloc(parser, MU_JSON_TOKEN_TYPE_NULL, N1);
+        break;
+    }
+
+    ACTION(Bo) {
+        // begin object
+        std_alloc(parser, MU_JSON_TOKEN_TYPE_OBJECT, OB);
+        push_container(parser);
+        break;
+    }
+
+    ACTION(Bs) {
+        // begin string
+        std_alloc(parser, MU_JSON_TOKEN_TYPE_STRING, ST);
+        if (parser->max_string > 0) {
+            // allow for open and close quotes
+            parser->string_limit_pos =
+                parser->char_pos + parser->max_string + 2;
+        }
+        break;
+    }
+
+    ACTION(Bt) {
+        // begin true
+        std_alloc(parser, MU_JSON_TOKEN_TYPE_TRUE, T1);
+        break;
+    }
+
+    ACTION(Bz) {
+        // Begin zero
+        std_alloc(parser, MU_JSON_TOKEN_TYPE_INTEGER, ZE);
+        break;
+    }
+
+    // These actions cause tokens to be finished and/or state change.
+    ACTION(Fa) {
+        // ] (finish array)
+        pop_container(parser, MU_JSON_TOKEN_TYPE_ARRAY);
+        break;
+    }
+
+    ACTION(Fo) {
+        // } (finish object)
+        pop_container(parser, MU_JSON_TOKEN_TYPE_OBJECT);
+        break;
+    }
+
+    ACTION(Pd) {
+        // Process decimal point: convert INTEGER to NUMBER
+        mu_json_token_t *token = tos(parser);
+        promote_to_number(parser, token);
+        set_state(parser, FR);
+        break;
+    }
+
+    ACTION(Pl) {
+        // Process colon
+        mu_json_token_t *token = tos(parser);
+        finish_token(parser, token, false);
+        set_state(parser, select_state(parser, __, __, __, VA));
+        break;
+    }
+
+    ACTION(Pm) {
+        // Process comma
+        mu_json_token_t *token = tos(parser);
+        finish_token(parser, token, false);
+        set_state(parser, select_state(parser, __, VA, KE, __));
+        break;
+    }
+
+    ACTION(Ps) {
+        // process trailing space
+        mu_json_token_t *token = tos(parser);
+        if (!is_container(token)) {
+            finish_token(parser, token, false);
+        }
+        set_state(parser,
+                  select_state(parser, OK, OK, OK, parser->state));
+        break;
+    }
+
+    ACTION(Pq) {
+        // Process closing quote:
+        mu_json_token_t *token = tos(parser);
+        finish_token(parser, token, true);
+        if (parser->projection && parser->is_key && !parser->eliding) {
+            project_key(parser, token);
+        }
+        parser->string_limit_pos = SIZE_MAX;
+        set_state(parser, select_state(parser, OK, OK, OK, CO));
+        break;
+    }
+
+    ACTION(Px) {
+        // Process exponent: convert INTEGER to NUMBER
+        mu_json_token_t *token = tos(parser);
+        promote_to_number(parser, token);
+        set_state(parser, E1);
+        break;
+    }
+
+    default: {
+        // Bad action.
+        parser->error = MU_JSON_ERR_BAD_FORMAT;
+        break;
+    }
+    } // switch(action)
+}
+
+#if MU_JSON_BATCH_LANES > 1
+static ALWAYS_INLINE bool lane_step(parser_t *parser) {
+    if (parser->state != ST &&
+        (size_t)parser->char_pos < parser->json->length &&
+        (size_t)parser->char_pos < parser->string_limit_pos) {
+        int next_state =
+            lookup_byte(parser->state, parser->json->buf[parser->char_pos]);
+        if (next_state < NR_STATES) {
+            // Simple state transition w/o special action
+            STATS_ADD(parser, transitions, 1);
+            parser->prev_state = parser->state;
+            parser->state = next_state;
+            parser->char_pos += 1;
+            return true;
+        } else if (next_state != __) {
+            parser->prev_state = parser->state;
+            perform_action(parser, next_state);
+            if (parser->error != MU_JSON_ERR_NONE) {
+                return false;
+            }
+            parser->char_pos += 1;
+            return true;
+        }
+    }
+    return parser_step(parser);
+}
+
+static bool lane_start(lane_t *lane, mu_json_batch_doc_t *docs, size_t n_docs,
+                       size_t *next_doc, mu_json_parse_opts_t *opts,
+                       size_t *n_parsed) {
+    while (*next_doc < n_docs) {
+        mu_json_batch_doc_t *doc = &docs[*next_doc];
+        lane->doc = (*next_doc)++;
+        mu_str_init(&lane->json, doc->buf, doc->buflen);
+        if (parser_init(&lane->parser, doc->tokens, doc->max_tokens,
+                        &lane->json, opts, INPUT_SIZED)) {
+            return true;
+        }
+        // rejected without scanning
+        doc->result = parser_finish(&lane->parser, opts);
+        *n_parsed += doc->result > 0;
+    }
+    return false;
+}
+#endif
+
+static int parser_finish(parser_t *parser, mu_json_parse_opts_t *opts) {
+    TRACE_PRINTF("\n=== endgame: depth=%d, state=%s, err=%d\n", parser->depth,
+                 state_name(parser->state), parser->error);
+
+    if (parser->nul_terminated) {
+        // Stopped before the NUL (error path only): bound the input for
+        // report_error() and unwind_containers().
+        const uint8_t *buf = mu_str_buf(parser->json);
+        mu_str_init(parser->json, buf,
+                    parser->char_pos +
+                        strlen((const char *)&buf[parser->char_pos]));
+    }
+
+    int retval;
+
+    if (parser->error != MU_JSON_ERR_NONE) {
         TRACE_PRINTF("\nendgame: parse error");
-        retval = parser.error;
-    } else if (parser.depth != 0) {
+        retval = parser->error;
+    } else if (parser->depth != 0) {
         TRACE_PRINTF("\nendgame: non-zero depth");
         retval = MU_JSON_ERR_INCOMPLETE;
-    } else if (parser.state != OK) {
+    } else if (parser->state != OK) {
         TRACE_PRINTF("\nendgame: final state != OK");
         retval = MU_JSON_ERR_BAD_FORMAT;
     } else {
-        mu_json_token_t *token = tos(&parser);
-        if (token) {
-            set_is_last(tos(&parser)); // mark last token as such
-            finish_token(&parser, mu_json_token_root(tos(&parser)), false);
+        if (parser->token_count > 0) {
+            // mark last token as such (tos() may be an elided stand-in)
+            set_is_last(&parser->tokens[parser->token_count - 1]);
+            finish_token(parser, &parser->tokens[0], false);
         }
         TRACE_PRINTF("\nendgame: success");
-        retval = parser.token_count;
+        retval = parser->token_count;
+    }
+    if (retval < 0) {
+        if (opts && opts->error) {
+            // the offending char, or __ at end of input
+            size_t pos = parser->char_pos;
+            int char_class = pos < mu_str_length(parser->json)
+                                 ? classify_char(mu_str_buf(parser->json)[pos])
+                                 : __;
+            report_error(parser, opts->error, retval, parser->prev_state,
+                         char_class);
+        }
+        unwind_containers(parser);
     }
+    STATS_ADD(parser, bytes, parser->char_pos);
     TRACE_PRINTF("...returning %d\n", retval);
     return retval;
 }
 
+static size_t find_split(const uint8_t *buf, size_t pos, size_t end,
+                         int state, int32_t depth) {
+    for (; pos < end; pos++) {
+        if (state == SCAN_OUT && depth == 1 && buf[pos] == ',') {
+            return pos + 1;
+        }
+        state = scan_byte(state, &depth, buf[pos]);
+    }
+    return 0;
+}
+
+static inline int scan_byte(int state, int32_t *depth, uint8_t ch) {
+    if (state == SCAN_ESC) {
+        return SCAN_IN; // the escaped char
+    } else if (state == SCAN_IN) {
+        return ch == '"' ? SCAN_OUT : ch == '\\' ? SCAN_ESC : SCAN_IN;
+    } else if (ch == '"') {
+        return SCAN_IN;
+    } else if (ch == '[' || ch == '{') {
+        *depth += 1;
+    } else if (ch == ']' || ch == '}') {
+        *depth -= 1;
+    }
+    return SCAN_OUT;
+}
+
+#if defined(DEPTH_LANES)
+static inline uint32_t depth_mask(const int16_t *depths, int16_t depth) {
+    // one pair of bits per lane whose depth is <= depth
+#if defined(__AVX2__)
+    __m256i v = _mm256_loadu_si256((const __m256i *)depths);
+    __m256i gt = _mm256_cmpgt_epi16(v, _mm256_set1_epi16(depth));
+    return ~(uint32_t)_mm256_movemask_epi8(gt);
+#else
+    __m128i v = _mm_loadu_si128((const __m128i *)depths);
+    __m128i gt = _mm_cmpgt_epi16(v, _mm_set1_epi16(depth));
+    return ~(uint32_t)_mm_movemask_epi8(gt) & 0xffff;
+#endif
+}
+#endif
+
+static size_t find_depth_at_most(const int16_t *depths, size_t from,
+                                 size_t to, int depth) {
+#if defined(DEPTH_LANES)
+    while (from + DEPTH_LANES <= to) {
+        uint32_t mask = depth_mask(&depths[from], depth);
+        if (mask) {
+            return from + __builtin_ctz(mask) / 2;
+        }
+        from += DEPTH_LANES;
+    }
+#endif
+    while (from < to && depths[from] > depth) {
+        from += 1;
+    }
+    return from;
+}
+
+static int rfind_depth_at_most(const int16_t *depths, int before, int depth) {
+    int i = before;
+#if defined(DEPTH_LANES)
+    while (i >= DEPTH_LANES) {
+        uint32_t mask = depth_mask(&depths[i - DEPTH_LANES], depth);
+        if (mask) {
+            return i - DEPTH_LANES + (31 - __builtin_clz(mask)) / 2;
+        }
+        i -= DEPTH_LANES;
+    }
+#endif
+    while (--i >= 0 && depths[i] > depth) {
+    }
+    return i;
+}
+
+static size_t skip_string_body(const uint8_t *buf, size_t pos, size_t end,
+                               size_t readable) {
+    while (pos < end && pos + sizeof(uint64_t) <= readable) {
+        uint64_t x;
+        memcpy(&x, &buf[pos], sizeof(x)); // unaligned load
+        uint64_t quote = x ^ (SWAR_ONES * '"');
+        uint64_t backslash = x ^ (SWAR_ONES * '\\');
+        uint64_t control = (x - SWAR_ONES * ' ') & ~x & SWAR_HIGHS;
+        if (SWAR_HAS_ZERO(quote) | SWAR_HAS_ZERO(backslash) | control) {
+            break; // find the special byte below
+        }
+        pos += sizeof(uint64_t);
+    }
+    if (pos > end) {
+        // padded input: the last word ran into the padding
+        return end;
+    }
+    uint8_t ch;
+    while (pos < end && (ch = buf[pos]) != '"' && ch != '\\' && ch >= ' ') {
+        pos += 1;
+    }
+    return pos;
+}
+
 static int classify_char(uint8_t ch) {
     if (ch >= sizeof(ascii_classes) / sizeof(ascii_classes[0])) {
         return C_ETC;
@@ -862,6 +2835,20 @@ static int classify_char(uint8_t ch) {
     }
 }
 
+#ifdef MU_JSON_FUSED_TABLE
+// Generated by tools/gen_fused_table from the two tables above.
+#include "mu_json_fused.h"
+
+static inline int lookup_byte(int state, uint8_t ch) {
+    return fused_transition_table[state][ch];
+}
+#else
+static inline int lookup_byte(int state, uint8_t ch) {
+    int char_class = classify_char(ch);
+    return char_class == __ ? __ : lookup_state(state, char_class);
+}
+#endif
+
 static void std_alloc(parser_t *parser, mu_json_token_type_t type, int s) {
     if (!begin_token(parser, type)) {
         parser->error = MU_JSON_ERR_NO_TOKENS;
@@ -872,20 +2859,38 @@ static void std_alloc(parser_t *parser, mu_json_token_type_t type, int s) {
 }
 
 static bool begin_token(parser_t *parser, mu_json_token_type_t type) {
-    if (parser->token_count >= parser->max_tokens) {
+    mu_json_token_t *token;
+    // Inside an object, a token begun in the OB or KE state is a key.
+    bool is_key = (parser->state == OB) || (parser->state == KE);
+
+    if (parser->projection && !project_token(parser, type, is_key)) {
+        // Off every selected path: validate the scalar, but keep no token
+        token = &parser->elided;
+        parser->eliding = true;
+    } else if ((size_t)(parser->token_count - parser->container - 1) >=
+                   parser->sparse_limit &&
+               should_elide(parser, type)) {
+        // Parse the scalar as usual, but into a token that isn't kept
+        open_container(parser)->flags |= MU_JSON_TOKEN_FLAG_IS_SPARSE;
+        token = &parser->elided;
+        parser->eliding = true;
+    } else if (parser->token_count >= parser->max_tokens) {
         return false;
+    } else {
+        token = &parser->tokens[parser->token_count++];
+        parser->eliding = false;
+        STATS_ADD(parser, tokens[type], 1);
     }
-    mu_json_token_t *token = &parser->tokens[parser->token_count++];
     memset(token, 0, sizeof(mu_json_token_t));
+    parser->is_key = is_key;
     // Since we haven't parsed to the end of this token yet, initialize the
     // token's string to start at char_pos and extend to the end of the input
     // string.  This will get adjusted in a call to finish_token() [q.v.].
     mu_str_slice(&token->json, parser->json, parser->char_pos, MU_STR_END);
     token->type = type;
-    if (parser->token_count == 1) {
+    if (parser->token_count == 1 && !parser->eliding) {
         set_is_first(token);
     }
-    token->flags |= parser->token_count == 1 ? MU_JSON_TOKEN_FLAG_IS_FIRST : 0;
     token->depth = parser->depth;
     // TRACE_PRINTF("\nStart %s", token_string(token));
     return true;
@@ -901,67 +2906,1057 @@ static void finish_token(parser_t *parser, mu_json_token_t *token,
         // already finished...
         return;
     }
-    // On entry, token->json extends from the token start to the end of
-    // the input string.  If incl_delim is true, slice it to end at
-    // parser->char_pos + 1, else at parser->char_pos.
+    // On entry, token->json starts at the token start and its length is not
+    // yet meaningful (see push_container()).  If incl_delim is true, slice it
+    // to end at parser->char_pos + 1, else at parser->char_pos.
     //
     // How it works:
     // start_index is the index of the start of the token's string **within the
     // original input string**.  Re-slice to start at start_index and end at
     // end_index.
-    int start_index = mu_str_length(parser->json) - mu_str_length(&token->json);
+    int start_index = mu_str_buf(&token->json) - mu_str_buf(parser->json);
     int end_index = incl_delim ? parser->char_pos + 1 : parser->char_pos;
     mu_str_slice(&token->json, parser->json, start_index, end_index);
     TRACE_PRINTF("\nFinish %s", token_string(token));
     seal_token(token);
+    if (parser->values && token != &parser->elided &&
+        (token->type == MU_JSON_TOKEN_TYPE_INTEGER ||
+         token->type == MU_JSON_TOKEN_TYPE_NUMBER)) {
+        const uint8_t *buf = mu_str_buf(&token->json);
+        mu_json_value_t *value = &parser->values[token - parser->tokens];
+        number_t num;
+        bool is_integer;
+        scan_number(buf, buf + mu_str_length(&token->json), &num, &is_integer);
+        if (is_integer) {
+            value->i = number_to_int64(&num);
+        } else {
+            value->d = number_to_double(&num);
+        }
+    }
+}
+
+static const uint8_t *scan_number(const uint8_t *p, const uint8_t *end,
+                                  number_t *num, bool *is_integer) {
+    *num = (number_t){.exact = true};
+    *is_integer = true;
+    num->negative = p < end && *p == '-';
+    p += num->negative;
+    num->text = p;
+    if (p == end || !is_digit(*p)) {
+        return NULL;
+    } else if (*p == '0') {
+        p += 1; // a leading zero stands alone
+    } else {
+        p = scan_digits(p, end, num, false);
+    }
+    if (p < end && *p == '.') {
+        *is_integer = false;
+        if (++p == end || !is_digit(*p)) {
+            return NULL;
+        }
+        while (num->mantissa == 0 && p < end && *p == '0') {
+            // leading zeros of a fraction aren't significant
+            num->exp10 -= 1;
+            p += 1;
+        }
+        p = scan_digits(p, end, num, true);
+    }
+    num->text_end = p;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        *is_integer = false;
+        p += 1;
+        bool exp_negative = p < end && *p == '-';
+        p += p < end && (*p == '-' || *p == '+');
+        if (p == end || !is_digit(*p)) {
+            return NULL;
+        }
+        int exponent = 0;
+        for (; p < end && is_digit(*p); p++) {
+            if (exponent < 100000) {
+                exponent = exponent * 10 + (*p - '0');
+            }
+        }
+        num->exponent = exp_negative ? -exponent : exponent;
+        num->exp10 += num->exponent;
+    }
+    return p;
+}
+
+static const uint8_t *scan_digits(const uint8_t *p, const uint8_t *end,
+                                  number_t *num, bool in_fraction) {
+#if defined(SWAR_DIGITS)
+    while (end - p >= 8 && num->n_digits <= 19 - 8) {
+        uint64_t x;
+        memcpy(&x, p, sizeof(x)); // unaligned load
+        if (!swar_is_eight_digits(x)) {
+            break; // finish the run below
+        }
+        num->mantissa = num->mantissa * 100000000 + swar_eight_digits(x);
+        num->n_digits += 8;
+        num->exp10 -= in_fraction ? 8 : 0;
+        p += 8;
+    }
+#endif
+    for (; p < end && is_digit(*p); p++) {
+        if (num->n_digits < 19) {
+            num->mantissa = num->mantissa * 10 + (*p - '0');
+            num->n_digits += 1;
+            num->exp10 -= in_fraction;
+        } else {
+            // beyond uint64_t: drop the digit, keeping its magnitude
+            num->exact = num->exact && *p == '0';
+            num->exp10 += !in_fraction;
+        }
+    }
+    return p;
+}
+
+static int64_t number_to_int64(const number_t *num) {
+    uint64_t limit = num->negative ? (uint64_t)INT64_MAX + 1 : INT64_MAX;
+    uint64_t magnitude = num->exp10 > 0 ? limit // digits were dropped
+                         : num->mantissa > limit ? limit
+                                                 : num->mantissa;
+    return num->negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+}
+
+static double number_to_double(const number_t *num) {
+    static const double pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                   1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                   1e18, 1e19, 1e20, 1e21, 1e22};
+    uint64_t mantissa = num->mantissa;
+    int exp10 = num->exp10;
+    double d;
+
+    if (num->exact && mantissa <= (1ULL << 53) && exp10 >= -22 &&
+        exp10 <= 22) {
+        // both operands are exact, so one rounding gives the correct result
+        d = exp10 < 0 ? (double)mantissa / pow10[-exp10]
+                      : (double)mantissa * pow10[exp10];
+    } else {
+        // Rewrite the number as "<digits>e<exponent>", which is independent
+        // of the locale's decimal point.  Beyond MAX_STRTOD_DIGITS, a final
+        // 1 stands for any nonzero digits dropped, so ties still round
+        // correctly.
+        char buf[MAX_STRTOD_DIGITS + 16];
+        int n = 0;
+        bool in_fraction = false;
+        bool dropped = false;
+        exp10 = num->exponent;
+        for (const uint8_t *p = num->text; p < num->text_end; p++) {
+            if (*p == '.') {
+                in_fraction = true;
+            } else if (n == 0 && *p == '0') {
+                exp10 -= in_fraction; // leading zero
+            } else if (n < MAX_STRTOD_DIGITS) {
+                buf[n++] = *p;
+                exp10 -= in_fraction;
+            } else {
+                dropped = dropped || *p != '0';
+                exp10 += !in_fraction;
+            }
+        }
+        if (dropped) {
+            buf[n++] = '1';
+            exp10 -= 1;
+        }
+        snprintf(&buf[n], sizeof(buf) - n, "e%d", exp10);
+        d = n == 0 ? 0.0 : strtod(buf, NULL);
+    }
+    return num->negative ? -d : d;
+}
+
+static int store_number(void *out, size_t i, numbers_kind_t kind,
+                        const number_t *num, bool is_integer) {
+    if (kind == NUMBERS_DOUBLE) {
+        ((double *)out)[i] = number_to_double(num);
+    } else if (kind == NUMBERS_FLOAT) {
+        ((float *)out)[i] = (float)number_to_double(num);
+    } else if (!is_integer) {
+        return MU_JSON_ERR_BAD_FORMAT;
+    } else {
+        int64_t v = number_to_int64(num);
+        if (v < INT32_MIN || v > INT32_MAX) {
+            return MU_JSON_ERR_LIMIT;
+        }
+        ((int32_t *)out)[i] = (int32_t)v;
+    }
+    return MU_JSON_ERR_NONE;
+}
+
+static int find_column(mu_json_extractor_t *extractor,
+                       key_prediction_t *predicted, int position,
+                       mu_str_t *key) {
+    const uint8_t *buf = mu_str_buf(key);
+    size_t length = mu_str_length(key);
+    key_prediction_t *prediction =
+        position < MU_JSON_EXTRACT_MAX_KEYS ? &predicted[position] : NULL;
+
+    if (prediction && prediction->length == length &&
+        memcmp(prediction->key, buf, length) == 0) {
+        return prediction->column; // same key as the previous record
+    }
+    extractor->key_searches += 1;
+    int found = -1;
+    for (size_t i = 0; i < extractor->n_columns; i++) {
+        mu_json_column_t *column = &extractor->columns[i];
+        // the slice includes the quotes
+        if (column->key_length + 2 == length &&
+            memcmp(column->key, buf + 1, column->key_length) == 0) {
+            found = (int)i;
+            break;
+        }
+    }
+    if (prediction) {
+        prediction->key = buf;
+        prediction->length = length;
+        prediction->column = found;
+    }
+    return found;
+}
+
+static void store_column(mu_json_column_t *column, size_t row,
+                         mu_json_token_t *value) {
+    int type = value ? value->type : MU_JSON_TOKEN_TYPE_UNKNOWN;
+    bool is_number = type == MU_JSON_TOKEN_TYPE_INTEGER ||
+                     type == MU_JSON_TOKEN_TYPE_NUMBER;
+    bool valid = false;
+    number_t num;
+    bool is_integer = false;
+
+    if (is_number) {
+        const uint8_t *buf = mu_str_buf(&value->json);
+        scan_number(buf, buf + mu_str_length(&value->json), &num, &is_integer);
+    }
+    switch (column->type) {
+    case MU_JSON_COLUMN_DOUBLE:
+        valid = is_number;
+        ((double *)column->values)[row] = valid ? number_to_double(&num) : 0;
+        break;
+    case MU_JSON_COLUMN_FLOAT:
+        valid = is_number;
+        ((float *)column->values)[row] =
+            valid ? (float)number_to_double(&num) : 0;
+        break;
+    case MU_JSON_COLUMN_INT32: {
+        int64_t v = is_integer ? number_to_int64(&num) : 0;
+        valid = is_integer && v >= INT32_MIN && v <= INT32_MAX;
+        ((int32_t *)column->values)[row] = valid ? (int32_t)v : 0;
+        break;
+    }
+    case MU_JSON_COLUMN_INT64:
+        valid = is_integer;
+        ((int64_t *)column->values)[row] = valid ? number_to_int64(&num) : 0;
+        break;
+    case MU_JSON_COLUMN_BOOL:
+        valid = type == MU_JSON_TOKEN_TYPE_TRUE ||
+                type == MU_JSON_TOKEN_TYPE_FALSE;
+        ((bool *)column->values)[row] = type == MU_JSON_TOKEN_TYPE_TRUE;
+        break;
+    case MU_JSON_COLUMN_STRING:
+        valid = type == MU_JSON_TOKEN_TYPE_STRING;
+        if (valid) {
+            ((mu_str_t *)column->values)[row] = value->json;
+        } else {
+            mu_str_init(&((mu_str_t *)column->values)[row], NULL, 0);
+        }
+        break;
+    }
+    if (column->valid) {
+        uint8_t bit = 1 << (row % 8);
+        if (valid) {
+            column->valid[row / 8] |= bit;
+        } else {
+            column->valid[row / 8] &= ~bit;
+        }
+    }
+}
+
+static int tokens_to_numbers(mu_json_token_t *array, void *out,
+                             size_t max_out, numbers_kind_t kind) {
+    size_t n = 0;
+
+    if (array == NULL || array->type != MU_JSON_TOKEN_TYPE_ARRAY) {
+        return MU_JSON_ERR_BAD_FORMAT;
+    } else if (array->flags & MU_JSON_TOKEN_FLAG_IS_SPARSE) {
+        // some elements have no tokens: decode them from the slice
+        return buffer_to_numbers(mu_str_buf(&array->json),
+                                 mu_str_length(&array->json), out, max_out,
+                                 kind);
+    }
+    for (mu_json_token_t *element = mu_json_token_child(array);
+         element != NULL; element = mu_json_token_next_sibling(element)) {
+        const uint8_t *buf = mu_str_buf(&element->json);
+        number_t num;
+        bool is_integer;
+        if (element->type != MU_JSON_TOKEN_TYPE_INTEGER &&
+            element->type != MU_JSON_TOKEN_TYPE_NUMBER) {
+            return MU_JSON_ERR_BAD_FORMAT;
+        } else if (n == max_out) {
+            return MU_JSON_ERR_LIMIT;
+        }
+        scan_number(buf, buf + mu_str_length(&element->json), &num,
+                    &is_integer);
+        int err = store_number(out, n++, kind, &num, is_integer);
+        if (err != MU_JSON_ERR_NONE) {
+            return err;
+        }
+    }
+    return (int)n;
+}
+
+static int buffer_to_numbers(const uint8_t *buf, size_t buflen, void *out,
+                             size_t max_out, numbers_kind_t kind) {
+    const uint8_t *end = buf + buflen;
+    const uint8_t *p = skip_whitespace(buf, end);
+    size_t n = 0;
+
+    if (p == end) {
+        return MU_JSON_ERR_INCOMPLETE;
+    } else if (*p != '[') {
+        return MU_JSON_ERR_BAD_FORMAT;
+    }
+    p = skip_whitespace(p + 1, end);
+    if (p < end && *p == ']') {
+        p += 1; // empty array
+    } else {
+        while (true) {
+            number_t num;
+            bool is_integer;
+            if (p == end) {
+                return MU_JSON_ERR_INCOMPLETE;
+            } else if ((p = scan_number(p, end, &num, &is_integer)) == NULL) {
+                return MU_JSON_ERR_BAD_FORMAT;
+            } else if (n == max_out) {
+                return MU_JSON_ERR_LIMIT;
+            }
+            int err = store_number(out, n++, kind, &num, is_integer);
+            if (err != MU_JSON_ERR_NONE) {
+                return err;
+            }
+            p = skip_whitespace(p, end);
+            if (p == end) {
+                return MU_JSON_ERR_INCOMPLETE;
+            } else if (*p == ']') {
+                p += 1;
+                break;
+            } else if (*p != ',') {
+                return MU_JSON_ERR_BAD_FORMAT;
+            }
+            p = skip_whitespace(p + 1, end);
+        }
+    }
+    // nothing but whitespace may follow the array
+    return skip_whitespace(p, end) == end ? (int)n : MU_JSON_ERR_BAD_FORMAT;
+}
+
+static const uint8_t *skip_whitespace(const uint8_t *p, const uint8_t *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        p += 1;
+    }
+    return p;
+}
+
+static bool should_elide(parser_t *parser, mu_json_token_type_t type) {
+    mu_json_token_t *container = open_container(parser);
+    return container != NULL && container->type == MU_JSON_TOKEN_TYPE_ARRAY &&
+           type != MU_JSON_TOKEN_TYPE_ARRAY &&
+           type != MU_JSON_TOKEN_TYPE_OBJECT;
+}
+
+static bool is_object_key(mu_json_token_t *token) {
+    if (token->type != MU_JSON_TOKEN_TYPE_STRING || token->depth == 0) {
+        return false;
+    }
+    // Inside a container, a delimiter follows before the input ends.
+    const uint8_t *p = mu_str_buf(&token->json) + mu_str_length(&token->json);
+    while (classify_char(*p) == C_SPACE || classify_char(*p) == C_WHITE) {
+        p += 1;
+    }
+    return *p == ':';
+}
+
+static int subtree_end(mu_json_token_t *tokens, int n_tokens, int i) {
+    int depth = tokens[i].depth;
+    while (++i < n_tokens && tokens[i].depth > depth) {
+    }
+    return i;
+}
+
+static size_t copy_tokens(mu_json_token_t *tokens, int n_tokens,
+                          uint8_t *buf) {
+    size_t pos = 0;
+    int container = -1;    // innermost open container (see push_container())
+    bool after_key = false; // true if the last member copied was a key
+
+    for (int i = 0; i < n_tokens; i++) {
+        mu_json_token_t *token = &tokens[i];
+        // close the containers that end before this token
+        while (container >= 0 && tokens[container].depth >= token->depth) {
+            mu_json_token_t *closed = &tokens[container];
+            container = (int)closed->json.length;
+            if (buf) {
+                buf[pos] = closed->type == MU_JSON_TOKEN_TYPE_ARRAY ? ']' : '}';
+                mu_str_init(&closed->json, closed->json.buf,
+                            &buf[pos + 1] - closed->json.buf);
+            }
+            pos += 1;
+        }
+        mu_json_token_t *prev = i > 0 ? &tokens[i - 1] : NULL;
+        if (prev && !(is_container(prev) && prev->depth < token->depth &&
+                      !(prev->flags & MU_JSON_TOKEN_FLAG_IS_SPARSE))) {
+            // not the first member of a container
+            if (buf) {
+                buf[pos] = after_key ? ':' : ',';
+            }
+            pos += 1;
+        }
+        after_key = !after_key && is_object_key(token);
+        if (is_container(token) &&
+            !(token->flags & MU_JSON_TOKEN_FLAG_IS_SPARSE)) {
+            if (buf) {
+                buf[pos] = token->type == MU_JSON_TOKEN_TYPE_ARRAY ? '[' : '{';
+                // length holds the parent until the container is closed
+                mu_str_init(&token->json, &buf[pos], (size_t)container);
+                container = i;
+            } else {
+                pos += 1; // for its closing bracket
+            }
+            pos += 1;
+            continue;
+        }
+        // a scalar, a key, or a sparse array and everything in it
+        const uint8_t *text = mu_str_buf(&token->json);
+        size_t length = mu_str_length(&token->json);
+        int end = subtree_end(tokens, n_tokens, i);
+        if (buf) {
+            memcpy(&buf[pos], text, length);
+            for (int j = i; j < end; j++) {
+                tokens[j].json.buf = &buf[pos] + (tokens[j].json.buf - text);
+            }
+        }
+        pos += length;
+        i = end - 1;
+    }
+    while (container >= 0) {
+        mu_json_token_t *closed = &tokens[container];
+        container = (int)closed->json.length;
+        buf[pos] = closed->type == MU_JSON_TOKEN_TYPE_ARRAY ? ']' : '}';
+        mu_str_init(&closed->json, closed->json.buf,
+                    &buf[pos + 1] - closed->json.buf);
+        pos += 1;
+    }
+    return pos;
+}
+
+static mu_json_err_t compile_name(const char **pp, mu_json_path_name_t *name) {
+    const char *p = *pp;
+
+    if (*p == '*') {
+        name->name = NULL;
+        *pp = p + 1;
+        return MU_JSON_ERR_NONE;
+    }
+    while (*p != '\0' && strchr(".[]()=!<> '\"", *p) == NULL) {
+        p += 1;
+    }
+    if (p == *pp) {
+        return MU_JSON_ERR_BAD_FORMAT;
+    }
+    name->name = *pp;
+    name->length = p - *pp;
+    *pp = p;
+    return MU_JSON_ERR_NONE;
+}
+
+static mu_json_err_t compile_bracket(const char **pp,
+                                     mu_json_path_step_t *step) {
+    const char *p = *pp;
+    mu_json_err_t err = MU_JSON_ERR_NONE;
+
+    if (*p == '*') {
+        step->op = MU_JSON_PATH_OP_WILDCARD;
+        p += 1;
+    } else if (is_digit(*p)) {
+        step->op = MU_JSON_PATH_OP_INDEX;
+        for (step->index = 0; is_digit(*p) && step->index < INT_MAX; p++) {
+            step->index = step->index * 10 + (*p - '0');
+        }
+    } else if (*p == '\'' || *p == '"') {
+        const char *end = strchr(p + 1, *p);
+        if (end == NULL) {
+            return MU_JSON_ERR_BAD_FORMAT;
+        }
+        step->op = MU_JSON_PATH_OP_CHILD;
+        step->name.name = p + 1;
+        step->name.length = end - (p + 1);
+        p = end + 1;
+    } else if (p[0] == '?' && p[1] == '(') {
+        p += 2;
+        step->op = MU_JSON_PATH_OP_FILTER;
+        err = compile_filter(&p, step);
+    } else {
+        err = MU_JSON_ERR_BAD_FORMAT;
+    }
+    if (err != MU_JSON_ERR_NONE) {
+        return err;
+    } else if (*p != ']') {
+        return MU_JSON_ERR_BAD_FORMAT;
+    }
+    *pp = p + 1;
+    return MU_JSON_ERR_NONE;
+}
+
+static mu_json_err_t compile_filter(const char **pp,
+                                    mu_json_path_step_t *step) {
+    static const struct {
+        const char *op;
+        mu_json_path_compare_t compare;
+    } s_ops[] = {
+        {"==", MU_JSON_PATH_EQ}, {"!=", MU_JSON_PATH_NE},
+        {"<=", MU_JSON_PATH_LE}, {">=", MU_JSON_PATH_GE},
+        {"<", MU_JSON_PATH_LT},  {">", MU_JSON_PATH_GT},
+    };
+    const char *p = *pp;
+    mu_json_err_t err = MU_JSON_ERR_NONE;
+
+    if (*p++ != '@') {
+        return MU_JSON_ERR_BAD_FORMAT;
+    }
+    while (*p == '.' && err == MU_JSON_ERR_NONE) {
+        if (step->n_keys == MU_JSON_PATH_MAX_FILTER_KEYS) {
+            return MU_JSON_ERR_LIMIT;
+        }
+        p += 1;
+        err = compile_name(&p, &step->keys[step->n_keys]);
+        if (step->keys[step->n_keys++].name == NULL) {
+            err = MU_JSON_ERR_BAD_FORMAT; // no wildcards in filters
+        }
+    }
+    while (*p == ' ') {
+        p += 1;
+    }
+    step->compare = MU_JSON_PATH_EXISTS;
+    for (size_t i = 0; i < sizeof(s_ops) / sizeof(s_ops[0]); i++) {
+        size_t length = strlen(s_ops[i].op);
+        if (strncmp(p, s_ops[i].op, length) == 0) {
+            step->compare = s_ops[i].compare;
+            p += length;
+            while (*p == ' ') {
+                p += 1;
+            }
+            if (err == MU_JSON_ERR_NONE) {
+                err = compile_literal(&p, step);
+            }
+            break;
+        }
+    }
+    while (*p == ' ') {
+        p += 1;
+    }
+    if (err != MU_JSON_ERR_NONE) {
+        return err;
+    } else if (*p != ')') {
+        return MU_JSON_ERR_BAD_FORMAT;
+    }
+    *pp = p + 1;
+    return MU_JSON_ERR_NONE;
+}
+
+static mu_json_err_t compile_literal(const char **pp,
+                                     mu_json_path_step_t *step) {
+    const char *p = *pp;
+    number_t num;
+    bool is_integer;
+
+    if (*p == '\'' || *p == '"') {
+        const char *end = strchr(p + 1, *p);
+        if (end == NULL) {
+            return MU_JSON_ERR_BAD_FORMAT;
+        }
+        step->literal = MU_JSON_TOKEN_TYPE_STRING;
+        step->name.name = p + 1;
+        step->name.length = end - (p + 1);
+        p = end + 1;
+    } else if (strncmp(p, "true", 4) == 0) {
+        step->literal = MU_JSON_TOKEN_TYPE_TRUE;
+        p += 4;
+    } else if (strncmp(p, "false", 5) == 0) {
+        step->literal = MU_JSON_TOKEN_TYPE_FALSE;
+        p += 5;
+    } else if (strncmp(p, "null", 4) == 0) {
+        step->literal = MU_JSON_TOKEN_TYPE_NULL;
+        p += 4;
+    } else {
+        const uint8_t *end = scan_number((const uint8_t *)p,
+                                         (const uint8_t *)p + strlen(p), &num,
+                                         &is_integer);
+        if (end == NULL) {
+            return MU_JSON_ERR_BAD_FORMAT;
+        }
+        step->literal = MU_JSON_TOKEN_TYPE_NUMBER;
+        step->number = number_to_double(&num);
+        p = (const char *)end;
+    }
+    *pp = p;
+    if (step->literal != MU_JSON_TOKEN_TYPE_NUMBER &&
+        step->compare != MU_JSON_PATH_EQ && step->compare != MU_JSON_PATH_NE) {
+        return MU_JSON_ERR_BAD_FORMAT; // only numbers are ordered
+    }
+    return MU_JSON_ERR_NONE;
+}
+
+static void eval_step(path_eval_t *eval, int k, mu_json_token_t *token) {
+    const mu_json_path_step_t *step = &eval->path->steps[k];
+    mu_json_token_t *t;
+
+    if (eval->stopped) {
+        return;
+    } else if (k == eval->path->n_steps) {
+        eval->matches += 1;
+        if (eval->callback && !eval->callback(token, eval->arg)) {
+            eval->stopped = true;
+        }
+        return;
+    }
+    switch (step->op) {
+    case MU_JSON_PATH_OP_CHILD:
+        if ((t = find_member(token, &step->name)) != NULL) {
+            eval_step(eval, k + 1, t);
+        }
+        break;
+    case MU_JSON_PATH_OP_INDEX:
+        if (token->type != MU_JSON_TOKEN_TYPE_ARRAY) {
+            break;
+        }
+        t = mu_json_token_child(token);
+        for (long i = 0; i < step->index && t != NULL; i++) {
+            t = mu_json_token_next_sibling(t);
+        }
+        if (t != NULL) {
+            eval_step(eval, k + 1, t);
+        }
+        break;
+    case MU_JSON_PATH_OP_WILDCARD:
+    case MU_JSON_PATH_OP_FILTER:
+        for (t = first_value(token); t != NULL; t = next_value(token, t)) {
+            if (step->op == MU_JSON_PATH_OP_WILDCARD ||
+                filter_matches(step, t)) {
+                eval_step(eval, k + 1, t);
+            }
+        }
+        break;
+    case MU_JSON_PATH_OP_DESCENDANT:
+        // one pass over the subtree, in document order
+        for (t = mu_json_token_next(token);
+             t != NULL && t->depth > token->depth; t = mu_json_token_next(t)) {
+            if (!is_object_key(t)) {
+                if (step->name.name == NULL) {
+                    eval_step(eval, k + 1, t);
+                }
+            } else if (step->name.name == NULL ||
+                       name_matches(t, &step->name)) {
+                t += 1;
+                eval_step(eval, k + 1, t);
+            }
+        }
+        break;
+    }
+}
+
+static bool filter_matches(const mu_json_path_step_t *step,
+                           mu_json_token_t *value) {
+    bool comparable = false; // a number compared with a number
+    bool equal;
+    double number = 0.0;
+
+    for (int i = 0; i < step->n_keys && value != NULL; i++) {
+        value = find_member(value, &step->keys[i]);
+    }
+    if (value == NULL) {
+        return false;
+    } else if (step->compare == MU_JSON_PATH_EXISTS) {
+        return true;
+    }
+    if (step->literal == MU_JSON_TOKEN_TYPE_NUMBER) {
+        if (value->type == MU_JSON_TOKEN_TYPE_INTEGER ||
+            value->type == MU_JSON_TOKEN_TYPE_NUMBER) {
+            const uint8_t *buf = mu_str_buf(&value->json);
+            number_t num;
+            bool is_integer;
+            scan_number(buf, buf + mu_str_length(&value->json), &num,
+                        &is_integer);
+            number = number_to_double(&num);
+            comparable = true;
+        }
+        equal = comparable && number == step->number;
+    } else if (step->literal == MU_JSON_TOKEN_TYPE_STRING) {
+        equal = value->type == MU_JSON_TOKEN_TYPE_STRING &&
+                name_matches(value, &step->name);
+    } else {
+        equal = value->type == step->literal;
+    }
+    switch (step->compare) {
+    case MU_JSON_PATH_EQ:
+        return equal;
+    case MU_JSON_PATH_NE:
+        return !equal;
+    case MU_JSON_PATH_LT:
+        return comparable && number < step->number;
+    case MU_JSON_PATH_LE:
+        return comparable && number <= step->number;
+    case MU_JSON_PATH_GT:
+        return comparable && number > step->number;
+    case MU_JSON_PATH_GE:
+        return comparable && number >= step->number;
+    default:
+        return false;
+    }
+}
+
+static mu_json_token_t *find_member(mu_json_token_t *object,
+                                    const mu_json_path_name_t *key) {
+    if (object->type != MU_JSON_TOKEN_TYPE_OBJECT) {
+        return NULL;
+    }
+    for (mu_json_token_t *t = mu_json_token_child(object); t != NULL;
+         t = mu_json_token_next_sibling(t + 1)) {
+        if (name_matches(t, key)) {
+            return t + 1; // a value always follows its key
+        }
+    }
+    return NULL;
+}
+
+static bool name_matches(mu_json_token_t *string,
+                         const mu_json_path_name_t *name) {
+    // the slice includes the quotes
+    return mu_str_length(&string->json) == name->length + 2 &&
+           memcmp(mu_str_buf(&string->json) + 1, name->name, name->length) ==
+               0;
+}
+
+static mu_json_token_t *first_value(mu_json_token_t *container) {
+    mu_json_token_t *child = mu_json_token_child(container);
+    if (child != NULL && container->type == MU_JSON_TOKEN_TYPE_OBJECT) {
+        return child + 1;
+    }
+    return child;
+}
+
+static mu_json_token_t *next_value(mu_json_token_t *container,
+                                   mu_json_token_t *value) {
+    mu_json_token_t *next = mu_json_token_next_sibling(value);
+    if (next != NULL && container->type == MU_JSON_TOKEN_TYPE_OBJECT) {
+        return next + 1;
+    }
+    return next;
+}
+
+static bool filter_record(mu_json_filter_t *filter, const uint8_t *record,
+                          size_t length) {
+    mu_json_parse_opts_t opts = {0};
+
+    if (filter->projected) {
+        opts.projection = &filter->projection;
+    }
+    filter->parsed += 1;
+    int n_tokens = mu_json_parse_buffer(filter->tokens, filter->max_tokens,
+                                        record, length, &opts);
+    if (n_tokens <= 0) {
+        filter->failed += 1;
+        filter->no_tokens += n_tokens == MU_JSON_ERR_NO_TOKENS;
+        return false;
+    }
+    for (size_t p = 0; p < filter->n_predicates; p++) {
+        if (!predicate_matches(&filter->predicates[p],
+                               resolve_pointer(filter, p))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static mu_json_token_t *resolve_pointer(mu_json_filter_t *filter, int p) {
+    mu_json_token_t *t = filter->tokens;
+
+    for (int i = 0; i < filter->n_segments[p] && t != NULL; i++) {
+        const mu_json_pointer_segment_t *segment =
+            &filter->projection.segments[i][p];
+        if (t->type == MU_JSON_TOKEN_TYPE_OBJECT) {
+            mu_json_token_t *key = mu_json_token_child(t);
+            while (key != NULL &&
+                   !segment_matches(segment, mu_str_buf(&key->json) + 1,
+                                    mu_str_length(&key->json) - 2)) {
+                key = mu_json_token_next_sibling(key + 1);
+            }
+            t = key ? key + 1 : NULL; // a value always follows its key
+        } else if (t->type == MU_JSON_TOKEN_TYPE_ARRAY && segment->index >= 0) {
+            t = mu_json_token_child(t);
+            for (long k = 0; k < segment->index && t != NULL; k++) {
+                t = mu_json_token_next_sibling(t);
+            }
+        } else {
+            t = NULL;
+        }
+    }
+    return t;
+}
+
+static bool predicate_matches(const mu_json_filter_predicate_t *predicate,
+                              mu_json_token_t *field) {
+    if (field == NULL) {
+        return false;
+    }
+    switch (predicate->op) {
+    case MU_JSON_FILTER_EXISTS:
+        return true;
+    case MU_JSON_FILTER_EQUALS:
+        return mu_str_compare_cstr(&field->json, predicate->value) == 0;
+    case MU_JSON_FILTER_RANGE: {
+        if (field->type != MU_JSON_TOKEN_TYPE_INTEGER &&
+            field->type != MU_JSON_TOKEN_TYPE_NUMBER) {
+            return false;
+        }
+        const uint8_t *buf = mu_str_buf(&field->json);
+        number_t num;
+        bool is_integer;
+        scan_number(buf, buf + mu_str_length(&field->json), &num, &is_integer);
+        double value = number_to_double(&num);
+        return value >= predicate->min && value <= predicate->max;
+    }
+    default:
+        return false;
+    }
+}
+
+static bool project_token(parser_t *parser, mu_json_token_type_t type,
+                          bool is_key) {
+    const mu_json_projection_t *projection = parser->projection;
+    int depth = parser->depth;
+    bool container = type == MU_JSON_TOKEN_TYPE_ARRAY ||
+                     type == MU_JSON_TOKEN_TYPE_OBJECT;
+    uint32_t mask;
+
+    if (depth > parser->skip_depth) {
+        return container;
+    } else if (depth > parser->keep_depth || is_key) {
+        return true;
+    } else if (depth == 0) {
+        mask = projection->all;
+    } else if (open_container(parser)->type == MU_JSON_TOKEN_TYPE_ARRAY) {
+        long index = parser->path_indexes[depth]++;
+        mask = 0;
+        for (uint32_t m = parser->path_masks[depth]; m != 0; m &= m - 1) {
+            int p = __builtin_ctz(m);
+            if (projection->segments[depth - 1][p].index == index) {
+                mask |= 1u << p;
+            }
+        }
+    } else {
+        mask = parser->key_mask;
+    }
+
+    if (mask == 0) {
+        if (container) {
+            parser->skip_depth = depth;
+        }
+        return container;
+    } else if (container && (mask & projection->complete[depth])) {
+        parser->keep_depth = depth;
+    } else if (container) {
+        parser->path_masks[depth + 1] = mask;
+        parser->path_indexes[depth + 1] = 0;
+    }
+    return true;
+}
+
+static void project_key(parser_t *parser, mu_json_token_t *key) {
+    int depth = parser->depth;
+
+    if (depth > parser->keep_depth) {
+        return;
+    }
+    // the key's slice includes its quotes
+    const uint8_t *buf = mu_str_buf(&key->json) + 1;
+    size_t length = mu_str_length(&key->json) - 2;
+    uint32_t mask = 0;
+    for (uint32_t m = parser->path_masks[depth]; m != 0; m &= m - 1) {
+        int p = __builtin_ctz(m);
+        if (segment_matches(&parser->projection->segments[depth - 1][p], buf,
+                            length)) {
+            mask |= 1u << p;
+        }
+    }
+    parser->key_mask = mask;
+    if (mask == 0) {
+        release_tokens(parser, parser->token_count - 1);
+    }
+}
+
+static void project_close(parser_t *parser, int index) {
+    int depth = parser->depth; // of the container just closed
+
+    if (depth == parser->keep_depth) {
+        parser->keep_depth = INT_MAX;
+    } else if (depth >= parser->skip_depth) {
+        if (depth == parser->skip_depth) {
+            parser->skip_depth = INT_MAX;
+        }
+        release_tokens(parser, index);
+    }
+}
+
+static void release_tokens(parser_t *parser, int index) {
+    parser->token_count = index;
+    memset(&parser->elided, 0, sizeof(mu_json_token_t));
+    seal_token(&parser->elided);
+    parser->eliding = true;
+}
+
+static bool segment_matches(const mu_json_pointer_segment_t *segment,
+                            const uint8_t *buf, size_t length) {
+    const char *key = segment->key;
+    size_t i = 0;
+
+    for (size_t j = 0; j < segment->length; j++, i++) {
+        char ch = key[j];
+        if (ch == '~') {
+            ch = key[++j] == '0' ? '~' : '/';
+        }
+        if (i == length || buf[i] != (uint8_t)ch) {
+            return false;
+        }
+    }
+    return i == length;
 }
 
 static mu_json_token_t *tos(parser_t *parser) {
-    if (parser->token_count == 0) {
+    if (parser->eliding) {
+        return &parser->elided;
+    } else if (parser->token_count == 0) {
         return NULL;
     } else {
         return &parser->tokens[parser->token_count - 1];
     }
 }
 
-static int select_state(mu_json_token_t *token, int not_in_container,
-                        int in_array, int in_object_key, int in_object_value) {
-    mu_json_token_t *container = mu_json_token_parent(token);
+static mu_json_token_t *open_container(parser_t *parser) {
+    if (parser->container < 0) {
+        return NULL;
+    } else {
+        return &parser->tokens[parser->container];
+    }
+}
 
-    if (token == NULL) {
+static void push_container(parser_t *parser) {
+    if (parser->error != MU_JSON_ERR_NONE) {
+        // token allocation failed
+        return;
+    }
+    mu_json_token_t *token = tos(parser);
+    if (parser->depth >= parser->max_depth) {
+        parser->error = MU_JSON_ERR_LIMIT;
+        return;
+    }
+    token->json.length = (size_t)parser->container;
+    parser->container = parser->token_count - 1;
+    parser->depth += 1;
+#ifdef MU_JSON_STATS
+    if (parser->stats && parser->depth > parser->stats->max_depth) {
+        parser->stats->max_depth = parser->depth;
+    }
+#endif
+}
+
+static void pop_container(parser_t *parser, mu_json_token_type_t type) {
+    LOOKUP_BEGIN(parser);
+    mu_json_token_t *container = open_container(parser);
+    mu_json_token_t *token = tos(parser);
+    LOOKUP_END(parser);
+
+    if ((container == NULL) || (container->type != type)) {
+        // close without open, or mismatched close
+        parser->error = MU_JSON_ERR_BAD_FORMAT;
+        return;
+    }
+    if (token != container) {
+        // Close any pending scalar (e.g. the `1` in `[1]`).  No-op if the
+        // last token was already finished.
+        finish_token(parser, token, false);
+    }
+    int index = parser->container;
+    parser->container = (int)container->json.length;
+    finish_token(parser, container, true);
+    parser->is_key = false; // a container is never an object key
+    parser->depth -= 1;
+    if (parser->projection) {
+        project_close(parser, index);
+    }
+    set_state(parser, OK);
+}
+
+static void unwind_containers(parser_t *parser) {
+    mu_json_token_t *container;
+
+    while ((container = open_container(parser)) != NULL) {
+        parser->container = (int)container->json.length;
+        mu_str_slice(&container->json, parser->json,
+                     mu_str_buf(&container->json) - mu_str_buf(parser->json),
+                     MU_STR_END);
+    }
+}
+
+static int select_state(parser_t *parser, int not_in_container, int in_array,
+                        int after_value, int after_key) {
+    LOOKUP_BEGIN(parser);
+    mu_json_token_t *container = open_container(parser);
+    LOOKUP_END(parser);
+
+    if (tos(parser) == NULL) {
         return __;
     } else if (container == NULL) {
         return not_in_container;
     } else if (container->type == MU_JSON_TOKEN_TYPE_ARRAY) {
         return in_array;
-    } else if ((child_count(container, token) & 1) == 0) {
-        // even number of children (or 0): expect key
-        return in_object_key;
+    } else if (parser->is_key) {
+        return after_key;
     } else {
-        return in_object_value;
+        return after_value;
     }
 }
 
-static int child_count(mu_json_token_t *container, mu_json_token_t *token) {
-    // Assumes that token is a direct child of an active container.  Count
-    // children of the container until token is seen
-    if (container == token) {
-        // handle the case where 0 children have been added to container.
-        return 0;
+static void report_error(parser_t *parser, mu_json_error_info_t *info,
+                         mu_json_err_t err, int state, int char_class) {
+    size_t length = mu_str_length(parser->json);
+    const uint8_t *buf = mu_str_buf(parser->json);
+    size_t char_pos = parser->char_pos;
+
+    if (char_pos > length) {
+        // error detected at end of input
+        char_pos = length;
     }
-    int count = 1;
-    mu_json_token_t *child = mu_json_token_child(container);
-    while (child != token) {
-        count += 1;
-        child = mu_json_token_next_sibling(child);
-        if (child == NULL) {
-            // shouldn't happen
-            TRACE_PRINTF("\n%s is not a child of container?",
-                         token_string(token));
-            return 0;
+    info->err = err;
+    info->char_pos = char_pos;
+    info->line = 1;
+    info->column = 1;
+    for (size_t i = 0; i < char_pos; i++) {
+        if (buf[i] == '\n') {
+            info->line += 1;
+            info->column = 1;
+        } else {
+            info->column += 1;
         }
     }
-    return count;
+    info->state = s_state_names[state];
+    if (char_pos == length) {
+        info->char_class = "end of input";
+    } else if (char_class == __) {
+        info->char_class = "illegal character";
+    } else {
+        info->char_class = s_ch_class_names[char_class];
+    }
+    info->container = parser->container;
 }
 
 static char *token_string(mu_json_token_t *token) {
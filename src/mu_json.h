@@ -29,8 +29,6 @@
  * * Start numbers as INTEGER type, promote to NUMBER type only as needed.
  * * Extend `finish_token()` to check that the token type being finished 
  *   matches the expected type, and write unit test to verify.
- * * Decide what to do with the `void *arg` argument on the parsers.  Provide
- *   more detailed error reporting if non-null?
  * * mu_json_token_t *mu_json_find_key(mu_json_token_t *object, const char *c_str, bool deep);
  * * mu_json_token_t *mu_json_find_key_value(mu_json_token_t *object, const char *c_str, bool deep);
  */
@@ -62,16 +60,43 @@ typedef enum {
     MU_JSON_ERR_NONE = 0,        /**< No error */
     MU_JSON_ERR_BAD_FORMAT = -1, /**< Illegal JSON format */
     MU_JSON_ERR_NO_TOKENS = -2,  /**< Not enough tokens provided */
-    MU_JSON_ERR_INCOMPLETE = -3  /**< JSON ended with unterminated form */
+    MU_JSON_ERR_INCOMPLETE = -3, /**< JSON ended with unterminated form */
+    MU_JSON_ERR_LIMIT = -4       /**< Input exceeds a configured limit */
 } mu_json_err_t;
 
+/**
+ * @brief The deepest container nesting the parser accepts.
+ *
+ * Token depths are stored as int16_t, so this is also the default (and
+ * largest) value for mu_json_parse_opts_t.max_depth.
+ */
+#define MU_JSON_MAX_DEPTH INT16_MAX
+
+/**
+ * @brief Number of readable bytes mu_json_parse_padded() requires past the end
+ * of its input.  The contents of the padding are never interpreted.
+ */
+#define MU_JSON_PADDING 8
+
+/**
+ * @brief The deepest container nesting accepted by mu_json_validate().
+ *
+ * mu_json_validate() tracks open containers in a bit stack of
+ * MU_JSON_VALIDATE_MAX_DEPTH / 8 bytes on the C stack.  Override at compile
+ * time to trade stack space for depth.
+ */
+#ifndef MU_JSON_VALIDATE_MAX_DEPTH
+#define MU_JSON_VALIDATE_MAX_DEPTH 1024
+#endif
+
 /**
  * @brief Enumeration of token flags used by mu_json.
  */
 typedef enum {
     MU_JSON_TOKEN_FLAG_IS_FIRST = 1,  /**< Token is first in token list */
     MU_JSON_TOKEN_FLAG_IS_LAST = 2,   /**< Token is last in token list */
-    MU_JSON_TOKEN_FLAG_IS_SEALED = 4  /**< Token end has been found */
+    MU_JSON_TOKEN_FLAG_IS_SEALED = 4, /**< Token end has been found */
+    MU_JSON_TOKEN_FLAG_IS_SPARSE = 8  /**< Array has untokenized elements */
 } mu_json_token_flags_t;
 
 #define DEFINE_MU_JSON_TOKEN_TYPES(M)                                          \
@@ -103,6 +128,451 @@ typedef struct {
     int16_t depth; /**< 0 = toplevel, n+1 = child of n... */
 } mu_json_token_t;
 
+/**
+ * @brief The decoded value of an INTEGER or NUMBER token.
+ *
+ * See mu_json_parse_opts_t.values: `i` holds an INTEGER token's value and
+ * `d` a NUMBER token's.  Other tokens' values are left untouched.
+ */
+typedef union {
+    int64_t i; /**< Value of an INTEGER token */
+    double d;  /**< Value of a NUMBER token */
+} mu_json_value_t;
+
+/**
+ * @brief Number of distinct parser actions counted in mu_json_stats_t.
+ */
+#define MU_JSON_STATS_N_ACTIONS 17
+
+/**
+ * @brief Parser instrumentation counters.
+ *
+ * Counters are only updated when mu_json.c is compiled with MU_JSON_STATS
+ * defined; otherwise the struct is left untouched and the parser pays no cost.
+ * Counters accumulate across calls: zero the struct to reset them.
+ *
+ * If MU_JSON_STATS_CLOCK is also defined (as an expression returning a
+ * monotonic tick count, e.g. a cycle counter), the time spent in the
+ * container-lookup helpers is accumulated in `lookup_ticks`.
+ */
+typedef struct {
+    size_t bytes;          /**< Bytes examined, including the end of input */
+    uint32_t tokens[MU_JSON_TOKEN_TYPE_NULL + 1]; /**< Tokens by type */
+    int max_depth;         /**< Deepest container nesting seen */
+    uint32_t transitions;  /**< Simple state transitions (no action) */
+    uint32_t actions[MU_JSON_STATS_N_ACTIONS]; /**< Transitions by action */
+    uint32_t lookups;      /**< Calls to the container-lookup helpers */
+    uint64_t lookup_ticks; /**< MU_JSON_STATS_CLOCK ticks spent in lookups */
+} mu_json_stats_t;
+
+/**
+ * @brief Detailed description of a parse error.
+ *
+ * Filled in when a parse fails and mu_json_parse_opts_t.error is non-NULL.
+ * The line and column are only computed on failure, so requesting an error
+ * report costs nothing when parsing succeeds.
+ */
+typedef struct {
+    mu_json_err_t err;      /**< Error code, as returned by the parser */
+    size_t char_pos;        /**< Byte offset of the offending character */
+    int line;               /**< 1-based line number of char_pos */
+    int column;             /**< 1-based column (in bytes) of char_pos */
+    const char *state;      /**< Name of the parser state that failed */
+    const char *char_class; /**< Name of the offending character class */
+    int container;          /**< Token index of innermost open container or -1 */
+} mu_json_error_info_t;
+
+/**
+ * @brief A table of where the elements of one parsed ARRAY begin, for random
+ * access by element index.  See mu_json_array_index_init().
+ *
+ * The caller supplies `entries`, which bounds the table's memory.  If the
+ * array has more elements than there are entries, the table records only
+ * every (1 << shift)'th element, and a lookup steps over at most
+ * (1 << shift) - 1 siblings from the nearest one.
+ */
+typedef struct {
+    mu_json_token_t *array; /**< The array indexed, or NULL if none yet */
+    int32_t *entries;       /**< Token offset from `array` of each entry */
+    size_t max_entries;     /**< Capacity of `entries` */
+    size_t n_entries;       /**< Entries in use */
+    int n_elements;         /**< Elements in the array */
+    int shift;              /**< Entry k is element k << shift */
+} mu_json_array_index_t;
+
+/**
+ * @brief Maximum number of steps in a compiled JSONPath expression.
+ */
+#ifndef MU_JSON_PATH_MAX_STEPS
+#define MU_JSON_PATH_MAX_STEPS 16
+#endif
+
+/**
+ * @brief Maximum number of names in a filter's relative path, e.g. 2 for
+ * `[?(@.a.b > 1)]`.
+ */
+#ifndef MU_JSON_PATH_MAX_FILTER_KEYS
+#define MU_JSON_PATH_MAX_FILTER_KEYS 4
+#endif
+
+/**
+ * @brief The instructions of a compiled JSONPath expression.
+ */
+typedef enum {
+    MU_JSON_PATH_OP_CHILD,      /**< `.name` or `['name']` */
+    MU_JSON_PATH_OP_INDEX,      /**< `[n]` */
+    MU_JSON_PATH_OP_WILDCARD,   /**< `.*` or `[*]` */
+    MU_JSON_PATH_OP_DESCENDANT, /**< `..name` or `..*` */
+    MU_JSON_PATH_OP_FILTER,     /**< `[?(@.name op literal)]` */
+} mu_json_path_op_t;
+
+/**
+ * @brief The comparisons a filter can make.
+ */
+typedef enum {
+    MU_JSON_PATH_EXISTS, /**< `[?(@.name)]` */
+    MU_JSON_PATH_EQ,
+    MU_JSON_PATH_NE,
+    MU_JSON_PATH_LT,
+    MU_JSON_PATH_LE,
+    MU_JSON_PATH_GT,
+    MU_JSON_PATH_GE,
+} mu_json_path_compare_t;
+
+/**
+ * @brief A name in a JSONPath expression, as written.
+ */
+typedef struct {
+    const char *name; /**< Points into the expression, NULL for `*` */
+    size_t length;    /**< Length of `name` */
+} mu_json_path_name_t;
+
+/**
+ * @brief One instruction of a compiled JSONPath expression.
+ */
+typedef struct {
+    uint8_t op;               /**< mu_json_path_op_t */
+    uint8_t compare;          /**< FILTER: mu_json_path_compare_t */
+    uint8_t literal;          /**< FILTER: mu_json_token_type_t of literal */
+    uint8_t n_keys;           /**< FILTER: names in the relative path */
+    mu_json_path_name_t name; /**< CHILD, DESCENDANT: the key; FILTER: a
+                                   string literal */
+    long index;               /**< INDEX: the element index */
+    double number;            /**< FILTER: a numeric literal */
+    mu_json_path_name_t keys[MU_JSON_PATH_MAX_FILTER_KEYS]; /**< FILTER */
+} mu_json_path_step_t;
+
+/**
+ * @brief A JSONPath expression compiled by mu_json_path_compile().  The
+ * expression string must outlive it.
+ */
+typedef struct {
+    mu_json_path_step_t steps[MU_JSON_PATH_MAX_STEPS];
+    int n_steps;
+} mu_json_path_t;
+
+/**
+ * @brief The signature for a user-supplied function that receives each match
+ * of mu_json_path_eval() (q.v.).
+ *
+ * @param match The matching token.
+ * @param arg The user argument passed to mu_json_path_eval().
+ * @return true to continue, false to stop the evaluation.
+ */
+typedef bool (*mu_json_path_callback_t)(mu_json_token_t *match, void *arg);
+
+/**
+ * @brief The signature for a user-supplied predicate to mu_json_compact()
+ * (q.v.).
+ *
+ * @param token The token being examined.
+ * @param arg The user argument passed to mu_json_compact().
+ * @return true to keep the token, false to remove it.
+ */
+typedef bool (*mu_json_token_predicate_t)(mu_json_token_t *token, void *arg);
+
+/**
+ * @brief Maximum number of JSON Pointers in a mu_json_projection_t (at most
+ * 32).
+ */
+#ifndef MU_JSON_PROJECT_MAX_POINTERS
+#define MU_JSON_PROJECT_MAX_POINTERS 8
+#endif
+
+/**
+ * @brief Maximum number of segments (reference tokens) in each of those
+ * pointers.
+ */
+#ifndef MU_JSON_PROJECT_MAX_SEGMENTS
+#define MU_JSON_PROJECT_MAX_SEGMENTS 8
+#endif
+
+/**
+ * @brief One segment of a JSON Pointer, e.g. `b` or `0` in `/a/b/0`.
+ */
+typedef struct {
+    const char *key; /**< The segment as written, with ~0 and ~1 escapes */
+    size_t length;   /**< Length of `key` */
+    long index;      /**< The segment as an array index, or -1 */
+} mu_json_pointer_segment_t;
+
+/**
+ * @brief A set of RFC 6901 JSON Pointers, prepared for a projection parse by
+ * mu_json_projection_init().  The pointer strings must outlive it.
+ */
+typedef struct {
+    /** segments[i][p] is segment i of pointer p */
+    mu_json_pointer_segment_t segments[MU_JSON_PROJECT_MAX_SEGMENTS]
+                                      [MU_JSON_PROJECT_MAX_POINTERS];
+    /** complete[n] has bit p set if pointer p has n segments */
+    uint32_t complete[MU_JSON_PROJECT_MAX_SEGMENTS + 1];
+    uint32_t all; /**< One bit per pointer */
+} mu_json_projection_t;
+
+/**
+ * @brief The tests a mu_json_filter_t can make of a field.
+ */
+typedef enum {
+    MU_JSON_FILTER_EXISTS, /**< The field is present */
+    MU_JSON_FILTER_EQUALS, /**< The field's JSON text is `value` */
+    MU_JSON_FILTER_RANGE,  /**< The field is a number in [min, max] */
+} mu_json_filter_op_t;
+
+/**
+ * @brief One condition on a record, e.g. `/level` EQUALS `"error"`.
+ */
+typedef struct {
+    const char *pointer; /**< JSON Pointer to the field, e.g. "/level" */
+    mu_json_filter_op_t op;
+    const char *value; /**< EQUALS: JSON text, e.g. "\"error\"" or "42" */
+    double min;        /**< RANGE: least value that matches */
+    double max;        /**< RANGE: greatest value that matches */
+} mu_json_filter_predicate_t;
+
+/**
+ * @brief A set of predicates, all of which a record must meet, prepared by
+ * mu_json_filter_init().  The fields are private to mu_json.c.
+ */
+typedef struct {
+    const mu_json_filter_predicate_t *predicates;
+    size_t n_predicates;
+    mu_json_projection_t projection; // parses only the predicates' fields
+    bool projected; // false if a field may be an array element
+    uint8_t n_segments[MU_JSON_PROJECT_MAX_POINTERS];
+    mu_str_t needles[2 * MU_JSON_PROJECT_MAX_POINTERS]; // text a match has
+    size_t n_needles;
+    mu_json_token_t *tokens; // scratch token store
+    size_t max_tokens;
+    size_t parsed; // records parsed after passing the prefilter
+    size_t failed; // ...that weren't valid JSON or didn't fit in `tokens`
+    size_t no_tokens; // ...that didn't fit in `tokens`
+} mu_json_filter_t;
+
+/**
+ * @brief Called with each record that a filter passes.
+ *
+ * @param record The record, a slice of the input without its newline.
+ * @param arg The user argument passed to mu_json_filter_ndjson().
+ * @return true to continue, false to stop filtering.
+ */
+typedef bool (*mu_json_filter_callback_t)(mu_str_t *record, void *arg);
+
+/**
+ * @brief Optional per-call parsing options, passed as the `arg` parameter of
+ * the @ref json_parsing functions.
+ *
+ * Zero-initialize the struct and set only the fields of interest.
+ *
+ * The limits guard against hostile input: they are checked as the input is
+ * scanned, and parsing stops with MU_JSON_ERR_LIMIT as soon as one is
+ * exceeded.  (The token budget is the `max_tokens` argument itself.)
+ *
+ * If `values` is non-NULL it must have room for `max_tokens` entries.  Each
+ * number is decoded as its token is completed, while its bytes are still in
+ * cache, and stored in values[i] for tokens[i].  INTEGERs outside the range
+ * of int64_t saturate to INT64_MIN or INT64_MAX; NUMBERs are correctly
+ * rounded.
+ *
+ * If `sparse_arrays` is true, an array that already holds
+ * `sparse_array_tokens` tokens (counting those of nested elements) gets no
+ * tokens for its remaining scalar elements, and is flagged
+ * MU_JSON_TOKEN_FLAG_IS_SPARSE.  Its container elements and their contents
+ * are still tokenized.  Token memory then grows with the structure of the
+ * document rather than with the size of its arrays; the elided elements
+ * remain in the array's slice (see mu_json_token_element_count() and
+ * mu_json_array_to_doubles()).  A threshold of 0 elides every scalar array
+ * element.  Object members are never elided.
+ *
+ * If `projection` is non-NULL, only tokens on or under its paths are kept: the
+ * ancestors of each selected value (with the keys that lead to it), the value
+ * itself and all of its contents.  Everything else is still validated, but
+ * its scalars never get a token, and its containers give theirs back as they
+ * close.  The token store must hold the kept tokens plus, at any moment, the
+ * unselected containers still open.  Keys are compared as written, so a key
+ * spelled with JSON escapes only matches a pointer spelled the same way.
+ */
+typedef struct {
+    mu_json_stats_t *stats; /**< If non-NULL, accumulates parser statistics */
+    mu_json_error_info_t *error; /**< If non-NULL, describes any parse error */
+    int max_depth;      /**< Max container nesting, 0 = MU_JSON_MAX_DEPTH */
+    size_t max_string_length; /**< Max bytes between quotes, 0 = unlimited */
+    size_t max_bytes;   /**< Max document length, 0 = unlimited */
+    mu_json_value_t *values; /**< If non-NULL, receives decoded numbers */
+    bool sparse_arrays; /**< If true, elide scalars of large arrays */
+    size_t sparse_array_tokens; /**< Tokens per array before eliding */
+    const mu_json_projection_t *projection; /**< If non-NULL, paths to keep */
+} mu_json_parse_opts_t;
+
+/**
+ * @brief Number of documents mu_json_parse_batch() parses in lockstep.
+ *
+ * With the default of 1, documents are parsed one after another by the fastest
+ * single-document engine.  Set to 2..8 to interleave that many documents; each
+ * lane costs one parser's state on the C stack.  Interleaving hides lookup
+ * latency but shares the branch predictor between lanes, so measure it on the
+ * target (see parse_messages_batch in bench/) before enabling it.
+ */
+#ifndef MU_JSON_BATCH_LANES
+#define MU_JSON_BATCH_LANES 1
+#endif
+
+/**
+ * @brief One document in a call to mu_json_parse_batch().
+ */
+typedef struct {
+    const uint8_t *buf;       /**< The JSON-formatted document */
+    size_t buflen;            /**< Length of `buf` */
+    mu_json_token_t *tokens;  /**< Token store for this document */
+    size_t max_tokens;        /**< Number of tokens in `tokens` */
+    int result; /**< Set to the token count, or a negative error code */
+} mu_json_batch_doc_t;
+
+/**
+ * @brief Maximum number of chunks in a mu_json_chunked_t.
+ */
+#ifndef MU_JSON_MAX_CHUNKS
+#define MU_JSON_MAX_CHUNKS 64
+#endif
+
+/**
+ * @brief One chunk of a document parsed with mu_json_chunked_init() et al.
+ *
+ * The fields are private to mu_json.c.
+ */
+typedef struct {
+    size_t start;          /**< Offset of the chunk's first byte */
+    size_t end;            /**< Offset one past the chunk's last byte */
+    size_t token_base;     /**< First token of the chunk's region */
+    size_t token_limit;    /**< Size of the chunk's token region */
+    int result;            /**< Tokens parsed, or a negative error code */
+    uint8_t exit_state[3]; /**< String state at `end`, by state at `start` */
+    int32_t depth_delta[3]; /**< Net nesting change, by state at `start` */
+} mu_json_chunk_t;
+
+/**
+ * @brief State of a chunked parse of one large document.
+ *
+ * See mu_json_chunked_init().  The fields are private to mu_json.c.
+ */
+typedef struct {
+    mu_json_token_t *tokens;   /**< Caller-supplied token store */
+    size_t max_tokens;         /**< Number of tokens in `tokens` */
+    const uint8_t *buf;        /**< The JSON-formatted document */
+    size_t buflen;             /**< Length of `buf` */
+    mu_json_parse_opts_t opts; /**< Copy of the caller's options */
+    mu_json_parse_opts_t *arg; /**< The caller's options, or NULL */
+    size_t root_start;         /**< Offset of the root's [ or { */
+    uint8_t root_type;         /**< Type of the root container */
+    size_t n_chunks;           /**< Number of chunks in use */
+    mu_json_chunk_t chunks[MU_JSON_MAX_CHUNKS];
+} mu_json_chunked_t;
+
+/**
+ * @brief Parsed tokens laid out as a struct of arrays.
+ *
+ * Each field of the tokens lives in its own caller-supplied array, indexed by
+ * token number, and slices are stored as 32-bit offsets from `base`.  The
+ * depths are contiguous, so the navigation functions compare many of them per
+ * instruction.  See mu_json_soa_init().
+ */
+typedef struct {
+    const uint8_t *base; /**< Start of the parsed input */
+    int16_t *depths;     /**< Depth of each token */
+    uint8_t *types;      /**< mu_json_token_type_t of each token */
+    uint8_t *flags;      /**< mu_json_token_flags_t of each token */
+    uint32_t *offsets;   /**< Start of each token's slice, from `base` */
+    uint32_t *lengths;   /**< Length of each token's slice */
+    size_t max_tokens;   /**< Capacity of each array */
+    size_t n_tokens;     /**< Number of tokens stored */
+} mu_json_soa_t;
+
+/**
+ * @brief A parsed document: the token store plus what the parse learned.
+ *
+ * A bare token pointer doesn't know where its store begins or ends, so
+ * finding the root or checking bounds means walking the flags.  The doc
+ * records the input, the token count and the outcome of the parse, which
+ * makes those O(1).  See mu_json_doc_init().
+ */
+typedef struct {
+    mu_json_token_t *tokens; /**< Caller-supplied token store */
+    size_t max_tokens;       /**< Number of tokens in `tokens` */
+    int n_tokens;            /**< Tokens parsed, 0 until a parse succeeds */
+    mu_json_err_t error;     /**< Outcome of the most recent parse */
+    const uint8_t *base;     /**< The parsed input */
+    size_t length;           /**< Length of the parsed input */
+    mu_json_soa_t *index;    /**< Optional navigation index, or NULL */
+    mu_json_stats_t *stats;  /**< Stats of the most recent parse, or NULL */
+} mu_json_doc_t;
+
+/**
+ * @brief Number of leading keys per record whose order
+ * mu_json_extract_columns() remembers.  Keys past this position are always
+ * searched for.
+ */
+#ifndef MU_JSON_EXTRACT_MAX_KEYS
+#define MU_JSON_EXTRACT_MAX_KEYS 32
+#endif
+
+/**
+ * @brief The C type of a column filled by mu_json_extract_columns().
+ */
+typedef enum {
+    MU_JSON_COLUMN_DOUBLE, /**< double, from INTEGER or NUMBER */
+    MU_JSON_COLUMN_FLOAT,  /**< float, from INTEGER or NUMBER */
+    MU_JSON_COLUMN_INT32,  /**< int32_t, from an INTEGER in range */
+    MU_JSON_COLUMN_INT64,  /**< int64_t, from INTEGER (saturating) */
+    MU_JSON_COLUMN_BOOL,   /**< bool, from TRUE or FALSE */
+    MU_JSON_COLUMN_STRING, /**< mu_str_t, the STRING's slice (with quotes) */
+} mu_json_column_type_t;
+
+/**
+ * @brief One output column: a field name and where to put its values.
+ *
+ * Row r's value goes in values[r].  Bit r of `valid` (bit r % 8 of byte
+ * r / 8) is set if the record had the field with a value of the right type,
+ * and cleared if the field was missing, null or of another type; the value is
+ * then zero.
+ */
+typedef struct {
+    const char *key;            /**< Field name, without quotes or escapes */
+    mu_json_column_type_t type; /**< Type of `values` */
+    void *values;               /**< Array of max_rows values */
+    uint8_t *valid;             /**< Bitmap of max_rows bits, or NULL */
+    size_t key_length;          /**< Private: strlen(key) */
+} mu_json_column_t;
+
+/**
+ * @brief Configuration and statistics for mu_json_extract_columns().  See
+ * mu_json_extractor_init().
+ */
+typedef struct {
+    mu_json_column_t *columns; /**< The columns to fill */
+    size_t n_columns;          /**< Number of columns */
+    size_t max_rows;           /**< Capacity of each column */
+    size_t key_searches; /**< Keys not in their predicted order, last call */
+} mu_json_extractor_t;
+
 // *****************************************************************************
 // Public declarations
 
@@ -123,12 +593,17 @@ typedef struct {
  * user-supplied `token_store` containing `max_tokens`. The JSON string
  * is expected to be null-terminated.
  *
+ * The string is parsed in a single pass: the NUL byte is recognized as the end
+ * of input, so no strlen() is run beforehand.  (If the parse fails before the
+ * NUL is reached, the remainder is measured to bound the error slices.)  When
+ * `max_bytes` is set, no more than `max_bytes` + 1 bytes are examined.
+ *
  * @param token_store A user-supplied array of tokens for receiving the parsed
  *        results.
  * @param max_tokens Number of tokens in `token_store`.
  * @param json The JSON-formatted string to be parsed, provided as a 
  *        null-terminated C string.
- * @param arg Reserved for future features.  For now, pass NULL.
+ * @param arg NULL, or a pointer to a mu_json_parse_opts_t.
  * @return Returns the number of parsed tokens if parsing is successful, or a
  *         negative error code if an error occurs.
  */
@@ -148,7 +623,7 @@ int mu_json_parse_c_str(mu_json_token_t *token_store, size_t max_tokens,
  * @param max_tokens Number of tokens in `token_store`.
  * @param mu_json Pointer to a mu_str_t object containing the JSON-formatted 
  *        string to be parsed.
- * @param arg Reserved for future features.  For now, pass NULL.
+ * @param arg NULL, or a pointer to a mu_json_parse_opts_t.
  * @return Returns the number of parsed tokens if parsing is successful, or a
  *         negative error code if an error occurs.
  */
@@ -171,13 +646,193 @@ int mu_json_parse_mu_str(mu_json_token_t *token_store, size_t max_tokens,
  * @param max_tokens Number of tokens in `token_store`.
  * @param buf Pointer to a uint8_t array containing the JSON-formatted buffer.
  * @param buflen Length of the JSON-formatted buffer `buf`.
- * @param arg Reserved for future features.  For now, pass NULL.
+ * @param arg NULL, or a pointer to a mu_json_parse_opts_t.
  * @return Returns the number of parsed tokens if parsing is successful, or a
  *         negative error code if an error occurs.
  */
 int mu_json_parse_buffer(mu_json_token_t *token_store, size_t max_tokens,
                          const uint8_t *buf, size_t buflen, void *arg);
 
+/**
+ * @brief Parse a JSON-formatted buffer followed by MU_JSON_PADDING readable
+ * bytes.
+ *
+ * @ingroup json_parsing
+ *
+ * Identical to mu_json_parse_buffer(), except that the caller guarantees that
+ * `buf[buflen]` through `buf[buflen + MU_JSON_PADDING - 1]` may be read.  This
+ * lets the scanner load whole words at the end of the input with no tail
+ * handling, which helps most on short messages.  See mu_json_pad_buffer().
+ *
+ * @param token_store A user-supplied array of tokens for receiving the parsed
+ *        results.
+ * @param max_tokens Number of tokens in `token_store`.
+ * @param buf Pointer to the JSON-formatted buffer, followed by padding.
+ * @param buflen Length of the JSON-formatted buffer, excluding padding.
+ * @param arg NULL, or a pointer to a mu_json_parse_opts_t.
+ * @return Returns the number of parsed tokens if parsing is successful, or a
+ *         negative error code if an error occurs.
+ */
+int mu_json_parse_padded(mu_json_token_t *token_store, size_t max_tokens,
+                         const uint8_t *buf, size_t buflen, void *arg);
+
+/**
+ * @brief Copy `srclen` bytes of `src` into `dst` and zero MU_JSON_PADDING
+ * bytes after them, ready for mu_json_parse_padded().
+ *
+ * @ingroup json_parsing
+ *
+ * `src` may equal `dst`, e.g. to pad a buffer that input was read into.
+ *
+ * @return `dst`, or NULL if `dst_size` is less than `srclen` +
+ *         MU_JSON_PADDING.
+ */
+uint8_t *mu_json_pad_buffer(uint8_t *dst, size_t dst_size, const uint8_t *src,
+                            size_t srclen);
+
+/**
+ * @brief Parse a batch of independent documents, interleaving them for
+ * throughput.
+ *
+ * @ingroup json_parsing
+ *
+ * Parsing one document is a serial chain of table lookups, each depending on
+ * the previous state.  When MU_JSON_BATCH_LANES > 1, mu_json_parse_batch()
+ * advances that many documents one character each in turn, so the CPU can
+ * overlap the lookups of different documents.  As each document finishes, the
+ * next one in `docs` takes its lane.
+ *
+ * Each document's result is stored in its `result` field, exactly as
+ * mu_json_parse_buffer() would return it.
+ *
+ * @param docs The documents to parse.
+ * @param n_docs Number of documents in `docs`.
+ * @param arg NULL, or a pointer to a mu_json_parse_opts_t.  The limits apply
+ *        to each document and the stats accumulate over the batch.  The
+ *        `error` report and `values` are not supported, and are ignored.
+ * @return The number of documents that parsed successfully.
+ */
+size_t mu_json_parse_batch(mu_json_batch_doc_t *docs, size_t n_docs,
+                           void *arg);
+
+/**
+ * @brief Begin a chunked parse of one large document.
+ *
+ * @ingroup json_parsing
+ *
+ * A chunked parse splits a document whose root is an array or an object into
+ * chunks that separate threads can parse at the same time.  It runs in five
+ * phases; the two marked "parallel" may be called for each chunk from a
+ * different thread, and the others must be called by one thread after all
+ * calls of the preceding phase have returned:
+ *
+ * 1. mu_json_chunked_init() divides the input into `n_chunks` equal spans.
+ * 2. mu_json_chunked_scan() (parallel) scans a span once, tracking quote and
+ *    escape state and net nesting depth from every state the span could
+ *    begin in: outside a string, inside one, or just after a backslash.
+ * 3. mu_json_chunked_plan() chains the spans' results -- a prefix computation
+ *    of quote parity and depth -- to learn the true state at each span's
+ *    start, then moves each split forward to just past the next comma
+ *    between two elements of the root.
+ * 4. mu_json_chunked_parse() (parallel) parses a chunk's elements into its
+ *    share of the token store, starting in the state the serial parser would
+ *    be in after that comma.
+ * 5. mu_json_chunked_finish() checks that each chunk ended where the next one
+ *    began, packs the chunks' tokens together and closes the root.
+ *
+ * The result is exactly what mu_json_parse_buffer() returns for the same
+ * arguments: tokens, flags, return value and error report.  Whenever the
+ * chunks can't reproduce it -- a scalar root, too few root elements, a parse
+ * error, a chunk running out of tokens, or `stats`, `values`,
+ * `sparse_arrays` or `projection` in the options -- the finish phase simply
+ * parses the document serially.
+ *
+ * @param chunked State for the chunked parse.
+ * @param token_store A user-supplied array of tokens for receiving the parsed
+ *        results.  Each chunk uses a share proportional to its length.
+ * @param max_tokens Number of tokens in `token_store`.
+ * @param buf Pointer to a uint8_t array containing the JSON-formatted buffer.
+ * @param buflen Length of the JSON-formatted buffer `buf`.
+ * @param n_chunks Number of chunks, clipped to 1..MU_JSON_MAX_CHUNKS.
+ * @param arg NULL, or a pointer to a mu_json_parse_opts_t.
+ * @return The number of chunks to pass to mu_json_chunked_scan().
+ */
+size_t mu_json_chunked_init(mu_json_chunked_t *chunked,
+                            mu_json_token_t *token_store, size_t max_tokens,
+                            const uint8_t *buf, size_t buflen,
+                            size_t n_chunks, void *arg);
+
+/**
+ * @brief Scan the quote, escape and nesting state of chunk i (parallel).
+ *
+ * @ingroup json_parsing
+ */
+void mu_json_chunked_scan(mu_json_chunked_t *chunked, size_t i);
+
+/**
+ * @brief Choose the chunk boundaries from the results of the scan phase.
+ *
+ * @ingroup json_parsing
+ *
+ * @return The number of chunks to pass to mu_json_chunked_parse(), or 0 if
+ *         the document will be parsed serially by mu_json_chunked_finish().
+ */
+size_t mu_json_chunked_plan(mu_json_chunked_t *chunked);
+
+/**
+ * @brief Parse chunk i into its share of the token store (parallel).
+ *
+ * @ingroup json_parsing
+ */
+void mu_json_chunked_parse(mu_json_chunked_t *chunked, size_t i);
+
+/**
+ * @brief Stitch the chunks' tokens together.
+ *
+ * @ingroup json_parsing
+ *
+ * @return The number of parsed tokens if parsing is successful, or a negative
+ *         error code, exactly as mu_json_parse_buffer() would return them.
+ */
+int mu_json_chunked_finish(mu_json_chunked_t *chunked);
+
+/**
+ * @brief Run every phase of a chunked parse on the calling thread.
+ *
+ * @ingroup json_parsing
+ *
+ * Useful for testing, and for measuring the overhead of chunking.  See
+ * mu_json_chunked_init() for the parameters.
+ */
+int mu_json_parse_chunked(mu_json_token_t *token_store, size_t max_tokens,
+                          const uint8_t *buf, size_t buflen, size_t n_chunks,
+                          void *arg);
+
+/**
+ * @brief Check that a buffer holds well-formed JSON without tokenizing it.
+ *
+ * @ingroup json_parsing
+ *
+ * mu_json_validate() runs the same grammar as the parsers, but tracks only
+ * whether each open container is an array or an object, so it needs no token
+ * store and uses MU_JSON_VALIDATE_MAX_DEPTH / 8 bytes of stack.
+ *
+ * @param buf Pointer to a uint8_t array containing the JSON-formatted buffer.
+ * @param buflen Length of the JSON-formatted buffer `buf`.
+ * @return MU_JSON_ERR_NONE if `buf` is well-formed, MU_JSON_ERR_LIMIT if it
+ *         nests deeper than MU_JSON_VALIDATE_MAX_DEPTH, or another negative
+ *         error code as returned by the parsers.
+ */
+mu_json_err_t mu_json_validate(const uint8_t *buf, size_t buflen);
+
+/**
+ * @brief Return the name of the i'th action counted in mu_json_stats_t
+ * (e.g. "Ba" for "begin array"), or NULL if out of range.
+ *
+ * @ingroup json_parsing
+ */
+const char *mu_json_stats_action_name(int i);
+
 /**
  * @defgroup token_accessor Accessors for parsed tokens
  * 
@@ -244,6 +899,21 @@ bool mu_json_token_is_first(mu_json_token_t *token);
  */
 bool mu_json_token_is_last(mu_json_token_t *token);
 
+/**
+ * @brief Return the number of elements of an ARRAY, or of members of an
+ * OBJECT.
+ *
+ * @ingroup token_accessor
+ *
+ * The count comes from the container's slice, so it includes any elements
+ * elided by a sparse parse (see mu_json_parse_opts_t).  This reads every byte
+ * of the slice.
+ *
+ * @param token Pointer to a parsed JSON token.
+ * @return The number of elements, or 0 if the token is not a container.
+ */
+int mu_json_token_element_count(mu_json_token_t *token);
+
 /**
  * @defgroup json_navigation Navigating parsed JSON tokens
  *
@@ -356,6 +1026,487 @@ mu_json_token_t *mu_json_token_prev_sibling(mu_json_token_t *token);
  */
 mu_json_token_t *mu_json_token_next_sibling(mu_json_token_t *token);
 
+/**
+ * @defgroup soa_navigation Navigating tokens in struct-of-arrays layout
+ * @brief Functions for navigating tokens stored in a mu_json_soa_t.
+ *
+ * These mirror the @ref json_navigation functions, but take and return token
+ * indexes, with -1 meaning "none".  Where a search over depths is needed, it
+ * compares 8 (SSE2) or 16 (AVX2) depths per instruction, so skipping a wide
+ * subtree costs a fraction of a pass over the array-of-structs tokens.
+ */
+
+/**
+ * @brief Initialize a mu_json_soa_t with caller-supplied arrays, each with
+ * room for `max_tokens` elements.
+ * @ingroup soa_navigation
+ */
+mu_json_soa_t *mu_json_soa_init(mu_json_soa_t *soa, int16_t *depths,
+                                uint8_t *types, uint8_t *flags,
+                                uint32_t *offsets, uint32_t *lengths,
+                                size_t max_tokens);
+
+/**
+ * @brief Copy `n_tokens` parsed tokens into struct-of-arrays layout.
+ * @ingroup soa_navigation
+ *
+ * @param soa An initialized mu_json_soa_t.
+ * @param tokens The tokens, as filled in by one of the @ref json_parsing
+ *        functions.  tokens[0] must be the root.
+ * @param n_tokens Number of tokens, as returned by the parse.
+ * @return `n_tokens`, MU_JSON_ERR_NO_TOKENS if it exceeds the arrays'
+ *         capacity, or MU_JSON_ERR_LIMIT if the input is too large for 32-bit
+ *         offsets.
+ */
+int mu_json_soa_from_tokens(mu_json_soa_t *soa, mu_json_token_t *tokens,
+                            int n_tokens);
+
+/**
+ * @brief Set `slice` to token i's slice of the input and return it, or
+ * return NULL if i is out of range.
+ * @ingroup soa_navigation
+ */
+mu_str_t *mu_json_soa_slice(mu_json_soa_t *soa, int i, mu_str_t *slice);
+
+/**
+ * @brief Return the index of token i's parent, or -1 for the root.
+ * @ingroup soa_navigation
+ */
+int mu_json_soa_parent(mu_json_soa_t *soa, int i);
+
+/**
+ * @brief Return the index of token i's first child, or -1 if it has none.
+ * @ingroup soa_navigation
+ */
+int mu_json_soa_child(mu_json_soa_t *soa, int i);
+
+/**
+ * @brief Return the index of token i's previous sibling, or -1 if none.
+ * @ingroup soa_navigation
+ */
+int mu_json_soa_prev_sibling(mu_json_soa_t *soa, int i);
+
+/**
+ * @brief Return the index of token i's next sibling, or -1 if none.
+ * @ingroup soa_navigation
+ */
+int mu_json_soa_next_sibling(mu_json_soa_t *soa, int i);
+
+/**
+ * @defgroup json_doc Parsed document handles
+ * @brief Functions for parsing into, and navigating, a mu_json_doc_t.
+ *
+ * The navigation functions take the doc along with the token, so they can
+ * check bounds and, when a navigation index is attached (see
+ * mu_json_doc_attach_index()), search depths with vector compares.
+ */
+
+/**
+ * @brief Initialize a doc with a caller-supplied token store.
+ * @ingroup json_doc
+ */
+mu_json_doc_t *mu_json_doc_init(mu_json_doc_t *doc,
+                                mu_json_token_t *token_store,
+                                size_t max_tokens);
+
+/**
+ * @brief Parse `buf` into the doc's token store.
+ * @ingroup json_doc
+ *
+ * Equivalent to mu_json_parse_buffer(), but also records the input, the
+ * result and the options' stats (if any) in the doc, and detaches any
+ * navigation index, which would describe the previous parse.
+ *
+ * @return The number of parsed tokens, or a negative error code.
+ */
+int mu_json_doc_parse(mu_json_doc_t *doc, const uint8_t *buf, size_t buflen,
+                      void *arg);
+
+/**
+ * @brief Build a struct-of-arrays navigation index for the doc's tokens in
+ * `index`, and use it for the doc's navigation from now on.
+ * @ingroup json_doc
+ *
+ * @return The number of tokens indexed, or a negative error code (see
+ *         mu_json_soa_from_tokens()).  On error, no index is attached.
+ */
+int mu_json_doc_attach_index(mu_json_doc_t *doc, mu_json_soa_t *index);
+
+/**
+ * @brief Return the number of tokens in the doc, 0 if the parse failed.
+ * @ingroup json_doc
+ */
+int mu_json_doc_token_count(mu_json_doc_t *doc);
+
+/**
+ * @brief Return the error from the doc's most recent parse, or
+ * MU_JSON_ERR_NONE if it succeeded.
+ * @ingroup json_doc
+ */
+mu_json_err_t mu_json_doc_error(mu_json_doc_t *doc);
+
+/**
+ * @brief Return the doc's root token, or NULL if it has none.  O(1).
+ * @ingroup json_doc
+ */
+mu_json_token_t *mu_json_doc_root(mu_json_doc_t *doc);
+
+/**
+ * @brief Return the doc's i'th token, or NULL if i is out of range.
+ * @ingroup json_doc
+ */
+mu_json_token_t *mu_json_doc_token(mu_json_doc_t *doc, int i);
+
+/**
+ * @brief Return the index of `token` in the doc, or -1 if it is not one of
+ * the doc's tokens.
+ * @ingroup json_doc
+ */
+int mu_json_doc_index_of(mu_json_doc_t *doc, mu_json_token_t *token);
+
+/**
+ * @brief Return the offset of the start of `token`'s slice within the
+ * parsed input, or -1 if it is not one of the doc's tokens.
+ * @ingroup json_doc
+ */
+int mu_json_doc_offset_of(mu_json_doc_t *doc, mu_json_token_t *token);
+
+/**
+ * @brief Return the parent of a token in the doc, or NULL if none.
+ * @ingroup json_doc
+ */
+mu_json_token_t *mu_json_doc_parent(mu_json_doc_t *doc,
+                                    mu_json_token_t *token);
+
+/**
+ * @brief Return the first child of a token in the doc, or NULL if none.
+ * @ingroup json_doc
+ */
+mu_json_token_t *mu_json_doc_child(mu_json_doc_t *doc,
+                                   mu_json_token_t *token);
+
+/**
+ * @brief Return the previous sibling of a token in the doc, or NULL if none.
+ * @ingroup json_doc
+ */
+mu_json_token_t *mu_json_doc_prev_sibling(mu_json_doc_t *doc,
+                                          mu_json_token_t *token);
+
+/**
+ * @brief Return the next sibling of a token in the doc, or NULL if none.
+ * @ingroup json_doc
+ */
+mu_json_token_t *mu_json_doc_next_sibling(mu_json_doc_t *doc,
+                                          mu_json_token_t *token);
+
+/**
+ * @defgroup typed_arrays Decoding arrays of numbers
+ * @brief Functions that decode an array of numbers into a C array.
+ *
+ * The `mu_json_array_to_*` functions decode the elements of a parsed ARRAY
+ * token, including any elided by a sparse parse.  The `mu_json_buffer_to_*`
+ * functions take the raw JSON instead, and decode it without allocating a
+ * token per element: the buffer must hold one array of numbers and nothing
+ * else (apart from whitespace).
+ *
+ * Runs of eight digits are converted at once with SWAR arithmetic.  Each
+ * function returns the number of elements stored in `out`, or:
+ * - MU_JSON_ERR_BAD_FORMAT if the input is not an array, or an element is
+ *   not a number (for int32: not an INTEGER),
+ * - MU_JSON_ERR_INCOMPLETE if a buffer ends where an element or the closing
+ *   `]` is expected,
+ * - MU_JSON_ERR_LIMIT if the array has more than `max_out` elements or (for
+ *   int32) an element is out of range.
+ */
+
+/**
+ * @brief Decode an ARRAY token's elements as doubles.
+ * @ingroup typed_arrays
+ */
+int mu_json_array_to_doubles(mu_json_token_t *array, double *out,
+                             size_t max_out);
+
+/**
+ * @brief Decode an ARRAY token's elements as floats.
+ * @ingroup typed_arrays
+ */
+int mu_json_array_to_float(mu_json_token_t *array, float *out, size_t max_out);
+
+/**
+ * @brief Decode an ARRAY token's INTEGER elements as int32_t.
+ * @ingroup typed_arrays
+ */
+int mu_json_array_to_int32(mu_json_token_t *array, int32_t *out,
+                           size_t max_out);
+
+/**
+ * @brief Decode a JSON array of numbers in `buf` as doubles, without tokens.
+ * @ingroup typed_arrays
+ */
+int mu_json_buffer_to_doubles(const uint8_t *buf, size_t buflen, double *out,
+                              size_t max_out);
+
+/**
+ * @brief Decode a JSON array of numbers in `buf` as floats, without tokens.
+ * @ingroup typed_arrays
+ */
+int mu_json_buffer_to_float(const uint8_t *buf, size_t buflen, float *out,
+                            size_t max_out);
+
+/**
+ * @brief Decode a JSON array of integers in `buf` as int32_t, without tokens.
+ * @ingroup typed_arrays
+ */
+int mu_json_buffer_to_int32(const uint8_t *buf, size_t buflen, int32_t *out,
+                            size_t max_out);
+
+/**
+ * @defgroup columns Extracting columns from an array of records
+ * @brief Functions that turn an array of objects into struct-of-arrays
+ * columns.
+ */
+
+/**
+ * @brief Prepare an extractor for the given columns.
+ * @ingroup columns
+ *
+ * Fill in each column's `key`, `type`, `values` and `valid` first.
+ */
+mu_json_extractor_t *mu_json_extractor_init(mu_json_extractor_t *extractor,
+                                            mu_json_column_t *columns,
+                                            size_t n_columns,
+                                            size_t max_rows);
+
+/**
+ * @brief Fill the extractor's columns from an ARRAY token of objects, one row
+ * per object, in one pass over the tokens.
+ * @ingroup columns
+ *
+ * Records are assumed to list their keys in the same order as the previous
+ * record, so each key is first compared with the key at the same position in
+ * that record, and the columns are searched only when it differs.  Fields
+ * that aren't columns are skipped, as are nested values.
+ *
+ * @return The number of rows, MU_JSON_ERR_BAD_FORMAT if `array` is not an
+ *         ARRAY or one of its elements is not an OBJECT, or MU_JSON_ERR_LIMIT
+ *         if it has more than max_rows elements.
+ */
+int mu_json_extract_columns(mu_json_extractor_t *extractor,
+                            mu_json_token_t *array);
+
+/**
+ * @brief Return true if row `row` of a column holds a value.
+ * @ingroup columns
+ */
+bool mu_json_column_is_valid(mu_json_column_t *column, size_t row);
+
+/**
+ * @defgroup projection Parsing selected paths only
+ * @brief Prepare JSON Pointers for mu_json_parse_opts_t.projection.
+ */
+
+/**
+ * @brief Prepare a set of JSON Pointers (e.g. "/a/b/0") for a projection
+ * parse.
+ * @ingroup projection
+ *
+ * The empty pointer "" selects the whole document.  An array index segment
+ * also matches an object key spelled the same way, as RFC 6901 specifies.
+ *
+ * @return MU_JSON_ERR_NONE, MU_JSON_ERR_BAD_FORMAT if a pointer is malformed
+ *         (it doesn't begin with `/`, or has a `~` not followed by 0 or 1), or
+ *         MU_JSON_ERR_LIMIT if there are more than
+ *         MU_JSON_PROJECT_MAX_POINTERS pointers or one has more than
+ *         MU_JSON_PROJECT_MAX_SEGMENTS segments.
+ */
+mu_json_err_t mu_json_projection_init(mu_json_projection_t *projection,
+                                      const char *const *pointers,
+                                      size_t n_pointers);
+
+/**
+ * @defgroup compact Compacting parsed documents
+ * @brief Functions that shrink a parsed document to the parts still needed.
+ */
+
+/**
+ * @brief Remove unwanted subtrees from a parsed document, in place.
+ * @ingroup compact
+ *
+ * `keep` is called in document order for each value whose container is kept:
+ * the root, each array element and each object member's value (whose key is
+ * `token - 1`).  It may navigate the tokens freely.  A value it rejects is
+ * removed with all of its contents, and with its key if it has one.  The kept
+ * tokens are moved to the front of the array with their depths unchanged, and
+ * the first and last are flagged as such.
+ *
+ * Each container's slice still spans its original text, removed members
+ * included; see mu_json_compact_copy().  Arrays indexed by token, such as
+ * mu_json_parse_opts_t.values, are not compacted.
+ *
+ * @return The number of tokens kept: 0 if the root was rejected.
+ */
+int mu_json_compact(mu_json_token_t *tokens, int n_tokens,
+                    mu_json_token_predicate_t keep, void *arg);
+
+/**
+ * @brief Copy the text of a parsed (and perhaps compacted) document into
+ * `buf`, re-slicing its tokens to refer to the copy, so that the original
+ * input may be freed.
+ * @ingroup compact
+ *
+ * The copy is the document as its tokens describe it, without whitespace: a
+ * container keeps only the members that still have tokens.  A sparse array's
+ * elements have no tokens, so its text is copied as it stands.  If `buf` is
+ * NULL, nothing is copied or changed and the size needed is returned.
+ *
+ * @return The number of bytes copied (or needed), or MU_JSON_ERR_LIMIT, with
+ *         the tokens unchanged, if `buflen` is too small.
+ */
+int mu_json_compact_copy(mu_json_token_t *tokens, int n_tokens, uint8_t *buf,
+                         size_t buflen);
+
+/**
+ * @defgroup array_index Random access to array elements
+ * @brief Functions that find the i'th element of an array without stepping
+ * over the elements before it.
+ */
+
+/**
+ * @brief Initialize an array index with caller-supplied entries.
+ * @ingroup array_index
+ */
+mu_json_array_index_t *mu_json_array_index_init(mu_json_array_index_t *index,
+                                                int32_t *entries,
+                                                size_t max_entries);
+
+/**
+ * @brief Index the elements of `array`, replacing any previous contents.
+ * @ingroup array_index
+ *
+ * Takes one pass over the array's tokens.  The array's tokens must not move
+ * while the index is in use.
+ *
+ * @return The number of elements, or MU_JSON_ERR_BAD_FORMAT if `array` is
+ *         not an ARRAY or is sparse (whose scalars have no tokens).
+ */
+int mu_json_array_index_build(mu_json_array_index_t *index,
+                              mu_json_token_t *array);
+
+/**
+ * @brief Return element `i` of `array`, or NULL if it has no such element.
+ * @ingroup array_index
+ *
+ * Indexes `array` first if it isn't the array last indexed.  O(1) once the
+ * array is indexed, if it has no more elements than the index has entries.
+ */
+mu_json_token_t *mu_json_array_index_get(mu_json_array_index_t *index,
+                                         mu_json_token_t *array, int i);
+
+/**
+ * @defgroup json_path Querying parsed documents with JSONPath
+ * @brief Functions that compile a JSONPath expression once and evaluate it
+ * over parsed tokens.
+ */
+
+/**
+ * @brief Compile a JSONPath expression.
+ * @ingroup json_path
+ *
+ * The supported subset is `$` followed by any of:
+ *
+ * - `.name`, `['name']` or `["name"]`: the member of an object
+ * - `[n]`: element n of an array
+ * - `.*` or `[*]`: every element or member value
+ * - `..name` or `..*`: the named member values, or all values, at any depth
+ * - `[?(@.a.b)]`: the elements or member values that have `.a.b`
+ * - `[?(@.a.b op literal)]`: ...whose `.a.b` compares with a number, a quoted
+ *   string, `true`, `false` or `null`, where op is one of `==`, `!=`, `<`,
+ *   `<=`, `>` or `>=`.  Strings compare only for (in)equality.
+ *
+ * Names are compared with keys as written, without decoding JSON escapes.
+ *
+ * @return MU_JSON_ERR_NONE, MU_JSON_ERR_BAD_FORMAT if the expression isn't in
+ *         the supported subset, or MU_JSON_ERR_LIMIT if it has more than
+ *         MU_JSON_PATH_MAX_STEPS steps or a filter path has more than
+ *         MU_JSON_PATH_MAX_FILTER_KEYS names.
+ */
+mu_json_err_t mu_json_path_compile(mu_json_path_t *path, const char *expr);
+
+/**
+ * @brief Call `callback` with each token that `path` selects from the
+ * document rooted at `root`, in document order.
+ * @ingroup json_path
+ *
+ * Each step considers only the children of the tokens matched by the step
+ * before, skipping every other subtree whole.  `..` may select a token more
+ * than once, e.g. `$..a..b` when `a` members nest.  `callback` may be NULL
+ * to count the matches.
+ *
+ * @return The number of matches.
+ */
+int mu_json_path_eval(const mu_json_path_t *path, mu_json_token_t *root,
+                      mu_json_path_callback_t callback, void *arg);
+
+/**
+ * @defgroup filter Filtering NDJSON records
+ * @brief Functions that pass through the records of newline-delimited JSON
+ * that meet simple conditions, without copying them.
+ */
+
+/**
+ * @brief Prepare a filter for records that meet all of `predicates`.
+ * @ingroup filter
+ *
+ * Each record that gets past the prefilter is parsed into `tokens` with a
+ * projection onto the predicates' fields.  That needs a token for each kept
+ * field, its keys and containers, and one for each level of nesting skipped
+ * around them, however large the records are.  But if a pointer has a segment
+ * such as `/0`, which could index an array, records are parsed whole, and
+ * `tokens` must hold every token of the largest record.  A record that doesn't
+ * fit doesn't match; the filter counts such records in `no_tokens`, and all
+ * records that failed to parse in `failed`.  The predicates and their strings
+ * must outlive the filter.
+ *
+ * @return MU_JSON_ERR_NONE, MU_JSON_ERR_BAD_FORMAT if a pointer is malformed
+ *         or an EQUALS predicate has no value, or MU_JSON_ERR_LIMIT if there
+ *         are more than MU_JSON_PROJECT_MAX_POINTERS predicates (see
+ *         mu_json_projection_init()).
+ */
+mu_json_err_t mu_json_filter_init(mu_json_filter_t *filter,
+                                  const mu_json_filter_predicate_t *predicates,
+                                  size_t n_predicates, mu_json_token_t *tokens,
+                                  size_t max_tokens);
+
+/**
+ * @brief Return true if one JSON record meets all of the filter's predicates.
+ * @ingroup filter
+ *
+ * Before parsing, the record is searched for text that any match must
+ * contain: each field's last key, and each EQUALS value.  Keys and EQUALS
+ * values are compared as written, so `"a\u0062"` does not equal `"ab"`, nor
+ * `1.0` equal `1` (use RANGE for numbers).  A record that isn't valid JSON
+ * doesn't match.
+ */
+bool mu_json_filter_match(mu_json_filter_t *filter, const uint8_t *record,
+                          size_t length);
+
+/**
+ * @brief Call `callback` with each line of `buf` that meets all of the
+ * filter's predicates, in order.
+ * @ingroup filter
+ *
+ * Rather than splitting `buf` into lines first, the filter searches ahead for
+ * the longest text that a match must contain, and only considers the line in
+ * which it is found; lines in between are skipped at the speed of
+ * mu_str_find_substr().  A trailing `\r` is trimmed from each line.  `buf`
+ * must be shorter than MU_STR_NOT_FOUND bytes.
+ *
+ * @return The number of matching records passed to `callback`.
+ */
+int mu_json_filter_ndjson(mu_json_filter_t *filter, const uint8_t *buf,
+                          size_t buflen, mu_json_filter_callback_t callback,
+                          void *arg);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,302 @@
+/**
+ * @file mu_json_batch.c
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 R. D. Poor <rdpoor # gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// *****************************************************************************
+// Includes
+
+#include "mu_json_batch.h"
+
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// *****************************************************************************
+// Private types and definitions
+
+#define QUEUE_MASK (MU_JSON_BATCH_QUEUE_SIZE - 1)
+
+// Failed attempts to find work before an idle worker goes to sleep
+#define IDLE_SPINS 64
+
+_Static_assert((MU_JSON_BATCH_QUEUE_SIZE & QUEUE_MASK) == 0,
+               "MU_JSON_BATCH_QUEUE_SIZE must be a power of two");
+
+// *****************************************************************************
+// Private (forward) declarations
+
+/**
+ * @brief Wake and join the first `n_started` workers, then release the pool's
+ * mutex and condition variable.
+ */
+static void stop_workers(mu_json_batch_t *batch, int n_started);
+
+/**
+ * @brief Body of each worker thread.
+ */
+static void *worker_main(void *arg);
+
+/**
+ * @brief Append a job to a worker's queue.  Called by the submitting thread
+ * only.  Return false if the queue is full.
+ */
+static bool queue_push(mu_json_batch_worker_t *worker,
+                       mu_json_batch_job_t *job);
+
+/**
+ * @brief Remove the oldest job from a worker's queue, or return NULL if it is
+ * empty.  Safe to call from any thread: the owner and thieves alike.
+ */
+static mu_json_batch_job_t *queue_take(mu_json_batch_worker_t *worker);
+
+/**
+ * @brief Take a job from any worker's queue other than `self`'s.
+ */
+static mu_json_batch_job_t *steal(mu_json_batch_t *batch,
+                                  mu_json_batch_worker_t *self);
+
+/**
+ * @brief Return true if any queue holds a job.
+ */
+static bool has_work(mu_json_batch_t *batch);
+
+/**
+ * @brief Block until a job is submitted or the pool is stopping.
+ */
+static void sleep_until_work(mu_json_batch_t *batch);
+
+/**
+ * @brief Return true if every submitted job has completed.
+ */
+static bool all_completed(mu_json_batch_t *batch);
+
+// *****************************************************************************
+// Public code
+
+bool mu_json_batch_init(mu_json_batch_t *batch, int n_workers) {
+    if (n_workers < 1 || n_workers > MU_JSON_BATCH_MAX_WORKERS) {
+        return false;
+    }
+    batch->n_workers = n_workers;
+    batch->next_worker = 0;
+    atomic_init(&batch->submitted, 0);
+    atomic_init(&batch->stopping, false);
+    atomic_init(&batch->n_sleeping, 0);
+    atomic_init(&batch->waiting, false);
+    pthread_mutex_init(&batch->mutex, NULL);
+    pthread_cond_init(&batch->wakeup, NULL);
+    for (int i = 0; i < n_workers; i++) {
+        mu_json_batch_worker_t *worker = &batch->workers[i];
+        atomic_init(&worker->head, 0);
+        atomic_init(&worker->tail, 0);
+        atomic_init(&worker->completed, 0);
+        worker->batch = batch;
+        worker->index = i;
+    }
+    for (int i = 0; i < n_workers; i++) {
+        mu_json_batch_worker_t *worker = &batch->workers[i];
+        if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0) {
+            stop_workers(batch, i);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool mu_json_batch_submit(mu_json_batch_t *batch, mu_json_batch_job_t *job) {
+    for (int i = 0; i < batch->n_workers; i++) {
+        mu_json_batch_worker_t *worker = &batch->workers[batch->next_worker];
+        if (++batch->next_worker == batch->n_workers) {
+            batch->next_worker = 0;
+        }
+        if (queue_push(worker, job)) {
+            // uncontended: only the submitter writes this count
+            atomic_fetch_add_explicit(&batch->submitted, 1,
+                                      memory_order_relaxed);
+            if (atomic_load(&batch->n_sleeping) > 0) {
+                // Holding the mutex ensures a worker that has not yet seen
+                // the job is already waiting, so the signal isn't lost.
+                pthread_mutex_lock(&batch->mutex);
+                pthread_cond_signal(&batch->wakeup);
+                pthread_mutex_unlock(&batch->mutex);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void mu_json_batch_wait(mu_json_batch_t *batch) {
+    for (int i = 0; i < IDLE_SPINS; i++) {
+        if (all_completed(batch)) {
+            return;
+        }
+        sched_yield();
+    }
+    pthread_mutex_lock(&batch->mutex);
+    // seq_cst: the last worker to complete a job either sees this flag or its
+    // job is seen below
+    atomic_store(&batch->waiting, true);
+    while (!all_completed(batch)) {
+        pthread_cond_wait(&batch->wakeup, &batch->mutex);
+    }
+    atomic_store(&batch->waiting, false);
+    pthread_mutex_unlock(&batch->mutex);
+}
+
+void mu_json_batch_deinit(mu_json_batch_t *batch) {
+    mu_json_batch_wait(batch);
+    stop_workers(batch, batch->n_workers);
+    batch->n_workers = 0;
+}
+
+// *****************************************************************************
+// Private (static) code
+
+static void stop_workers(mu_json_batch_t *batch, int n_started) {
+    atomic_store(&batch->stopping, true);
+    pthread_mutex_lock(&batch->mutex);
+    pthread_cond_broadcast(&batch->wakeup);
+    pthread_mutex_unlock(&batch->mutex);
+    for (int i = 0; i < n_started; i++) {
+        pthread_join(batch->workers[i].thread, NULL);
+    }
+    pthread_cond_destroy(&batch->wakeup);
+    pthread_mutex_destroy(&batch->mutex);
+}
+
+static void *worker_main(void *arg) {
+    mu_json_batch_worker_t *self = (mu_json_batch_worker_t *)arg;
+    mu_json_batch_t *batch = self->batch;
+    int idle = 0;
+
+    while (true) {
+        mu_json_batch_job_t *job = queue_take(self);
+        if (job == NULL) {
+            job = steal(batch, self);
+        }
+        if (job != NULL) {
+            mu_json_batch_doc_t *doc = &job->doc;
+            doc->result = mu_json_parse_buffer(doc->tokens, doc->max_tokens,
+                                               doc->buf, doc->buflen,
+                                               job->arg);
+            if (job->callback) {
+                job->callback(job);
+            }
+            // uncontended: only this thread writes its count.  seq_cst:
+            // ordered before the check of `waiting`.
+            atomic_fetch_add(&self->completed, 1);
+            if (atomic_load(&batch->waiting) && all_completed(batch)) {
+                // Broadcast, as idle workers sleep on the same condition.
+                pthread_mutex_lock(&batch->mutex);
+                pthread_cond_broadcast(&batch->wakeup);
+                pthread_mutex_unlock(&batch->mutex);
+            }
+            idle = 0;
+        } else if (atomic_load(&batch->stopping)) {
+            return NULL;
+        } else if (++idle < IDLE_SPINS) {
+            sched_yield();
+        } else {
+            idle = 0;
+            sleep_until_work(batch);
+        }
+    }
+}
+
+static bool queue_push(mu_json_batch_worker_t *worker,
+                       mu_json_batch_job_t *job) {
+    size_t tail = atomic_load_explicit(&worker->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&worker->head, memory_order_acquire);
+    if (tail - head >= MU_JSON_BATCH_QUEUE_SIZE) {
+        return false;
+    }
+    atomic_store_explicit(&worker->slots[tail & QUEUE_MASK], job,
+                          memory_order_relaxed);
+    // seq_cst: ordered before the submitter's check of n_sleeping
+    atomic_store(&worker->tail, tail + 1);
+    return true;
+}
+
+static mu_json_batch_job_t *queue_take(mu_json_batch_worker_t *worker) {
+    size_t head = atomic_load_explicit(&worker->head, memory_order_acquire);
+    while (true) {
+        size_t tail = atomic_load(&worker->tail);
+        if (head == tail) {
+            return NULL;
+        }
+        // The slot can't be reused until head moves past it, so this read is
+        // good if the exchange below succeeds.
+        mu_json_batch_job_t *job = atomic_load_explicit(
+            &worker->slots[head & QUEUE_MASK], memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(
+                &worker->head, &head, head + 1, memory_order_acq_rel,
+                memory_order_acquire)) {
+            return job;
+        }
+    }
+}
+
+static mu_json_batch_job_t *steal(mu_json_batch_t *batch,
+                                  mu_json_batch_worker_t *self) {
+    // start with the next worker so thieves spread out
+    for (int i = 1; i < batch->n_workers; i++) {
+        int victim = (self->index + i) % batch->n_workers;
+        mu_json_batch_job_t *job = queue_take(&batch->workers[victim]);
+        if (job != NULL) {
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static bool has_work(mu_json_batch_t *batch) {
+    for (int i = 0; i < batch->n_workers; i++) {
+        mu_json_batch_worker_t *worker = &batch->workers[i];
+        if (atomic_load(&worker->tail) != atomic_load(&worker->head)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sleep_until_work(mu_json_batch_t *batch) {
+    pthread_mutex_lock(&batch->mutex);
+    // seq_cst: a submitter either sees this count or we see its job
+    atomic_fetch_add(&batch->n_sleeping, 1);
+    if (!has_work(batch) && !atomic_load(&batch->stopping)) {
+        pthread_cond_wait(&batch->wakeup, &batch->mutex);
+    }
+    atomic_fetch_sub(&batch->n_sleeping, 1);
+    pthread_mutex_unlock(&batch->mutex);
+}
+
+static bool all_completed(mu_json_batch_t *batch) {
+    size_t completed = 0;
+    for (int i = 0; i < batch->n_workers; i++) {
+        completed += atomic_load(&batch->workers[i].completed);
+    }
+    return completed >= atomic_load(&batch->submitted);
+}
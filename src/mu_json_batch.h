@@ -0,0 +1,169 @@
+/**
+ * @file mu_json_batch.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 R. D. Poor <rdpoor # gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief A pool of worker threads that parse independent documents.
+ *
+ * mu_json_batch is an optional add-on for hosted systems: it needs POSIX
+ * threads and C11 atomics, which mu_json itself does not.  Like mu_json, it
+ * allocates no memory: the caller supplies the mu_json_batch_t, the jobs and
+ * their token stores.
+ *
+ * Each worker owns a queue of jobs.  mu_json_batch_submit() deals jobs to the
+ * queues in turn; a worker takes jobs from its own queue and, once that is
+ * empty, steals from the others.  Queues are lock-free, so the only lock is
+ * the one idle workers sleep on.
+ */
+
+#ifndef _MU_JSON_BATCH_H_
+#define _MU_JSON_BATCH_H_
+
+// *****************************************************************************
+// Includes
+
+#include "mu_json.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// *****************************************************************************
+// C++ Compatibility
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// *****************************************************************************
+// Public types and definitions
+
+/**
+ * @brief Maximum number of worker threads in a mu_json_batch_t.
+ */
+#ifndef MU_JSON_BATCH_MAX_WORKERS
+#define MU_JSON_BATCH_MAX_WORKERS 16
+#endif
+
+/**
+ * @brief Number of jobs each worker's queue holds.  Must be a power of two.
+ */
+#ifndef MU_JSON_BATCH_QUEUE_SIZE
+#define MU_JSON_BATCH_QUEUE_SIZE 256
+#endif
+
+typedef struct mu_json_batch_job_s mu_json_batch_job_t;
+
+/**
+ * @brief Called on a worker thread when a job has been parsed.
+ */
+typedef void (*mu_json_batch_callback_t)(mu_json_batch_job_t *job);
+
+/**
+ * @brief A document to parse, and what to do when it has been parsed.
+ *
+ * The job, its buffer and its token store belong to the caller, and must
+ * remain valid until the job's callback has been called.
+ */
+struct mu_json_batch_job_s {
+    mu_json_batch_doc_t doc; /**< Buffer and token store; receives result */
+    void *arg; /**< NULL, or a mu_json_parse_opts_t for this job alone */
+    mu_json_batch_callback_t callback; /**< If non-NULL, called when done */
+    void *context;                     /**< For use by the caller */
+};
+
+/**
+ * @brief One worker thread and its job queue.  Private to mu_json_batch.c.
+ *
+ * `head` is advanced by the owner and by thieves, `tail` only by the
+ * submitting thread and `completed` only by the owner, so each gets its own
+ * cache line.
+ */
+typedef struct {
+    _Alignas(64) atomic_size_t head; /**< Next job to take */
+    _Alignas(64) atomic_size_t tail; /**< Next free slot */
+    _Alignas(64) atomic_size_t completed; /**< Jobs finished by this worker */
+    _Atomic(mu_json_batch_job_t *) slots[MU_JSON_BATCH_QUEUE_SIZE];
+    pthread_t thread;
+    struct mu_json_batch_s *batch;
+    int index;
+} mu_json_batch_worker_t;
+
+/**
+ * @brief A pool of worker threads.  The fields are private to
+ * mu_json_batch.c.
+ */
+typedef struct mu_json_batch_s {
+    mu_json_batch_worker_t workers[MU_JSON_BATCH_MAX_WORKERS];
+    int n_workers;
+    int next_worker;         // queue that receives the next submitted job
+    atomic_size_t submitted; // jobs submitted so far
+    atomic_bool stopping;    // set by mu_json_batch_deinit()
+    atomic_int n_sleeping;   // workers waiting on `wakeup`
+    atomic_bool waiting;     // the submitter is waiting on `wakeup` too
+    pthread_mutex_t mutex;   // guards sleeping and waiting only
+    pthread_cond_t wakeup;
+} mu_json_batch_t;
+
+// *****************************************************************************
+// Public declarations
+
+/**
+ * @brief Start a pool of `n_workers` threads.
+ *
+ * @return true on success, false if `n_workers` is not in
+ *         1..MU_JSON_BATCH_MAX_WORKERS or a thread could not be started.
+ */
+bool mu_json_batch_init(mu_json_batch_t *batch, int n_workers);
+
+/**
+ * @brief Queue a job for parsing.
+ *
+ * The job is parsed as if by mu_json_parse_buffer(), whose result is stored in
+ * `job->doc.result`, and then its callback (if any) is called on the worker
+ * thread.  Only one thread at a time may submit jobs to a pool.
+ *
+ * @return true if the job was queued, false if every queue is full.
+ */
+bool mu_json_batch_submit(mu_json_batch_t *batch, mu_json_batch_job_t *job);
+
+/**
+ * @brief Wait until every submitted job has completed.
+ *
+ * Call from the submitting thread, which sleeps unless the jobs complete
+ * soon.
+ */
+void mu_json_batch_wait(mu_json_batch_t *batch);
+
+/**
+ * @brief Finish any outstanding jobs and stop the pool's threads.
+ */
+void mu_json_batch_deinit(mu_json_batch_t *batch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _MU_JSON_BATCH_H_ */
@@ -0,0 +1,573 @@
+/**
+ * @file mu_json_fused.h
+ *
+ * Generated by tools/gen_fused_table -- do not edit.
+ *
+ * Maps (state, input byte) directly to the next state: the
+ * composition of ascii_classes[] and state_transition_table[]
+ * in mu_json.c, which includes this file when built with
+ * MU_JSON_FUSED_TABLE.
+ */
+
+// clang-format off
+static const uint8_t fused_transition_table[NR_STATES][256] = {
+/*GO*/ {
+    __,__,__,__,__,__,__,__,__,GO,GO,__,__,GO,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    GO,__,Bs,__,__,__,__,__,__,__,__,__,__,Bm,__,__,
+    Bz,Bd,Bd,Bd,Bd,Bd,Bd,Bd,Bd,Bd,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,Ba,__,__,__,__,
+    __,__,__,__,__,__,Bf,__,__,__,__,__,__,__,Bn,__,
+    __,__,__,__,Bt,__,__,__,__,__,__,Bo,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*OK*/ {
+    __,__,__,__,__,__,__,__,__,Ps,Ps,__,__,Ps,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    Ps,__,__,__,__,__,__,__,__,__,__,__,Pm,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,Fa,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,Fo,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*OB*/ {
+    __,__,__,__,__,__,__,__,__,OB,OB,__,__,OB,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    OB,__,Bs,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,Fo,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*KE*/ {
+    __,__,__,__,__,__,__,__,__,KE,KE,__,__,KE,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    KE,__,Bs,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*CO*/ {
+    __,__,__,__,__,__,__,__,__,Ps,Ps,__,__,Ps,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    Ps,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,Pl,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*VA*/ {
+    __,__,__,__,__,__,__,__,__,VA,VA,__,__,VA,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    VA,__,Bs,__,__,__,__,__,__,__,__,__,__,Bm,__,__,
+    Bz,Bd,Bd,Bd,Bd,Bd,Bd,Bd,Bd,Bd,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,Ba,__,__,__,__,
+    __,__,__,__,__,__,Bf,__,__,__,__,__,__,__,Bn,__,
+    __,__,__,__,Bt,__,__,__,__,__,__,Bo,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*AR*/ {
+    __,__,__,__,__,__,__,__,__,AR,AR,__,__,AR,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    AR,__,Bs,__,__,__,__,__,__,__,__,__,__,Bm,__,__,
+    Bz,Bd,Bd,Bd,Bd,Bd,Bd,Bd,Bd,Bd,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,Ba,__,Fa,__,__,
+    __,__,__,__,__,__,Bf,__,__,__,__,__,__,__,Bn,__,
+    __,__,__,__,Bt,__,__,__,__,__,__,Bo,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*ST*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    ST,ST,Pq,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ES,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,
+},
+/*ES*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,ST,__,__,__,__,__,__,__,__,__,__,__,__,ST,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,ST,__,__,__,
+    __,__,ST,__,__,__,ST,__,__,__,__,__,__,__,ST,__,
+    __,__,ST,__,ST,U1,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*U1*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    U2,U2,U2,U2,U2,U2,U2,U2,U2,U2,__,__,__,__,__,__,
+    __,U2,U2,U2,U2,U2,U2,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,U2,U2,U2,U2,U2,U2,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*U2*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    U3,U3,U3,U3,U3,U3,U3,U3,U3,U3,__,__,__,__,__,__,
+    __,U3,U3,U3,U3,U3,U3,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,U3,U3,U3,U3,U3,U3,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*U3*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    U4,U4,U4,U4,U4,U4,U4,U4,U4,U4,__,__,__,__,__,__,
+    __,U4,U4,U4,U4,U4,U4,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,U4,U4,U4,U4,U4,U4,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*U4*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    ST,ST,ST,ST,ST,ST,ST,ST,ST,ST,__,__,__,__,__,__,
+    __,ST,ST,ST,ST,ST,ST,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,ST,ST,ST,ST,ST,ST,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*MI*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    ZE,IN,IN,IN,IN,IN,IN,IN,IN,IN,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*ZE*/ {
+    __,__,__,__,__,__,__,__,__,Ps,Ps,__,__,Ps,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    Ps,__,__,__,__,__,__,__,__,__,__,__,Pm,__,Pd,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,Px,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,Fa,__,__,
+    __,__,__,__,__,Px,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,Fo,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*IN*/ {
+    __,__,__,__,__,__,__,__,__,Ps,Ps,__,__,Ps,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    Ps,__,__,__,__,__,__,__,__,__,__,__,Pm,__,Pd,__,
+    IN,IN,IN,IN,IN,IN,IN,IN,IN,IN,__,__,__,__,__,__,
+    __,__,__,__,__,Px,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,Fa,__,__,
+    __,__,__,__,__,Px,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,Fo,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*FR*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    FS,FS,FS,FS,FS,FS,FS,FS,FS,FS,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*FS*/ {
+    __,__,__,__,__,__,__,__,__,Ps,Ps,__,__,Ps,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    Ps,__,__,__,__,__,__,__,__,__,__,__,Pm,__,__,__,
+    FS,FS,FS,FS,FS,FS,FS,FS,FS,FS,__,__,__,__,__,__,
+    __,__,__,__,__,Px,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,Fa,__,__,
+    __,__,__,__,__,Px,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,Fo,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*E1*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,E2,__,E2,__,__,
+    E3,E3,E3,E3,E3,E3,E3,E3,E3,E3,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*E2*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    E3,E3,E3,E3,E3,E3,E3,E3,E3,E3,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*E3*/ {
+    __,__,__,__,__,__,__,__,__,Ps,Ps,__,__,Ps,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    Ps,__,__,__,__,__,__,__,__,__,__,__,Pm,__,__,__,
+    E3,E3,E3,E3,E3,E3,E3,E3,E3,E3,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,Fa,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,Fo,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*T1*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,T2,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*T2*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,T3,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*T3*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,OK,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*F1*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,F2,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*F2*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,F3,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*F3*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,F4,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*F4*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,OK,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*N1*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,N2,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*N2*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,N3,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+/*N3*/ {
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,OK,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+    __,__,__,__,__,__,__,__,__,__,__,__,__,__,__,__,
+},
+};
+// clang-format on
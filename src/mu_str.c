@@ -42,6 +42,15 @@ void *memrchr(const void *s, int c, size_t n);
 // *****************************************************************************
 // Private types and definitions
 
+// Substring search tests eight candidate positions at a time, relying on
+// little-endian loads to visit them in order.
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) &&                            \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define SWAR_SEARCH
+#define SWAR_ONES 0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+#endif
+
 // *****************************************************************************
 // Private (static) storage
 
@@ -406,6 +415,7 @@ static int find_substr_aux(mu_str_t *str, const uint8_t *substring,
                            int substring_len, bool skip_substr) {
     const uint8_t *hay_bytes = str->buf;
     int hay_len = str->length;
+    int i = 0;
     int j;
 
     if (substring_len == 0) {
@@ -413,11 +423,40 @@ static int find_substr_aux(mu_str_t *str, const uint8_t *substring,
         return 0;
     }
 
+#ifdef SWAR_SEARCH
+    // Compare eight positions at once against both the first and the last
+    // byte of substring, and only check the rest where both match.  Most text
+    // is rejected without a byte-at-a-time loop.
+    uint64_t first = SWAR_ONES * substring[0];
+    uint64_t last = SWAR_ONES * substring[substring_len - 1];
+    for (; i + substring_len - 1 + 8 <= hay_len; i += 8) {
+        uint64_t a, b;
+        __builtin_memcpy(&a, &hay_bytes[i], sizeof(a)); // unaligned loads
+        __builtin_memcpy(&b, &hay_bytes[i + substring_len - 1], sizeof(b));
+        uint64_t x = (a ^ first) | (b ^ last); // zero bytes are candidates
+        // The high bit of each zero byte, exactly (no borrows between bytes)
+        uint64_t candidates =
+            ~(((x & ~SWAR_HIGHS) + ~SWAR_HIGHS) | x) & SWAR_HIGHS;
+        while (candidates != 0) {
+            int k = i + __builtin_ctzll(candidates) / 8;
+            for (j = 1; j < substring_len - 1; j++) {
+                if (hay_bytes[k + j] != substring[j]) {
+                    break;
+                }
+            }
+            if (j >= substring_len - 1) {
+                return skip_substr ? k + substring_len : k;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+#endif
+
     // First scan through str looking for a byte that matches the first
     // byte of substring.  Micro-optimization: We stop searching when we get
     // within substring_len bytes of the end of str, since beyond that, the
     // full-length search will always fail.
-    for (int i = 0; i <= hay_len - substring_len; i++) {
+    for (; i <= hay_len - substring_len; i++) {
         const uint8_t *h2 = &hay_bytes[i];
         if (*h2 == *substring) {
             // first byte matches.  Do the rest of the bytes match?
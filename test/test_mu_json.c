@@ -30,6 +30,7 @@
 #include "unity.h"
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 DEFINE_FFF_GLOBALS;
 
@@ -38,10 +39,44 @@ DEFINE_FFF_GLOBALS;
 
 static uint8_t json_buf[MAX_JSON_STRING];
 static mu_json_token_t s_tokens[MAX_TOKENS];
+static mu_json_token_t s_chunk_tokens[MAX_TOKENS];
 
 static const char *s_json =
     "{ \"a\" : 10 , \"b\" : 11 , \"c\" : [ 3, 4.5 ], \"d\" : [ ] } ";
 
+/**
+ * @brief Return true if mu_json_parse_chunked() splitting buf into n_chunks
+ * returns exactly what mu_json_parse_buffer() does: the same result, the same
+ * tokens and the same error report.
+ */
+static bool chunked_matches_serial(const uint8_t *buf, size_t buflen,
+                                   size_t n_chunks) {
+    mu_json_error_info_t serial_error, chunked_error;
+    mu_json_parse_opts_t opts = {0};
+
+    opts.error = &serial_error;
+    int expected = mu_json_parse_buffer(s_tokens, MAX_TOKENS, buf, buflen,
+                                        &opts);
+    opts.error = &chunked_error;
+    int result = mu_json_parse_chunked(s_chunk_tokens, MAX_TOKENS, buf,
+                                       buflen, n_chunks, &opts);
+    if (result != expected || memcmp(&serial_error, &chunked_error,
+                                     sizeof(mu_json_error_info_t)) != 0) {
+        return false;
+    }
+    for (int i = 0; i < expected; i++) {
+        mu_json_token_t *a = &s_tokens[i];
+        mu_json_token_t *b = &s_chunk_tokens[i];
+        if (a->type != b->type || a->flags != b->flags ||
+            a->depth != b->depth ||
+            mu_str_buf(&a->json) != mu_str_buf(&b->json) ||
+            mu_str_length(&a->json) != mu_str_length(&b->json)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void setUp(void) {
     // Reset all faked functions
 }
@@ -84,11 +119,75 @@ static bool check_format(const char *filename, bool expected_outcome) {
     // that 0 tokens signifies an error.  Therefore, we set success true only if
     // one ore more tokens are parsed;
     //
-    if (mu_json_parse_buffer(s_tokens, MAX_TOKENS, json_buf, n_read, NULL) >
-        0) {
+    int n_tokens =
+        mu_json_parse_buffer(s_tokens, MAX_TOKENS, json_buf, n_read, NULL);
+    if (n_tokens > 0) {
         succeeded = true;
     }
 
+    // json_buf is zeroed past n_read, so it can be parsed as padded input.
+    if ((size_t)n_read + MU_JSON_PADDING <= sizeof(json_buf) &&
+        mu_json_parse_padded(s_tokens, MAX_TOKENS, json_buf, n_read, NULL) !=
+            n_tokens) {
+        fprintf(stderr, "test error: mu_json_parse_padded() disagrees on %s\n",
+                filename);
+        return false;
+    }
+
+    // mu_json_validate() must agree with the parser, unless the parser simply
+    // ran out of token storage.
+    if (n_tokens != MU_JSON_ERR_NO_TOKENS &&
+        (mu_json_validate(json_buf, n_read) == MU_JSON_ERR_NONE) !=
+            succeeded) {
+        fprintf(stderr, "test error: mu_json_validate() disagrees on %s\n",
+                filename);
+        return false;
+    }
+
+    if (!chunked_matches_serial(json_buf, n_read, 4) ||
+        !chunked_matches_serial(json_buf, n_read, 7)) {
+        fprintf(stderr, "test error: mu_json_parse_chunked() disagrees on %s\n",
+                filename);
+        return false;
+    }
+
+    // Eliding array scalars must not change which inputs are accepted.
+    mu_json_parse_opts_t sparse = {.sparse_arrays = true};
+    if (n_tokens != MU_JSON_ERR_NO_TOKENS &&
+        (mu_json_parse_buffer(s_chunk_tokens, MAX_TOKENS, json_buf, n_read,
+                              &sparse) > 0) != succeeded) {
+        fprintf(stderr, "test error: sparse parse disagrees on %s\n",
+                filename);
+        return false;
+    }
+
+    // ...nor must projecting the document onto a few paths.
+    static const char *const pointers[] = {"/0", "/a/b", "/1/a"};
+    mu_json_projection_t projection;
+    mu_json_projection_init(&projection, pointers, 3);
+    mu_json_parse_opts_t projected = {.projection = &projection};
+    if (n_tokens != MU_JSON_ERR_NO_TOKENS &&
+        (mu_json_parse_buffer(s_chunk_tokens, MAX_TOKENS, json_buf, n_read,
+                              &projected) > 0) != succeeded) {
+        fprintf(stderr, "test error: projected parse disagrees on %s\n",
+                filename);
+        return false;
+    }
+
+    // Copying a document must give one that parses to the same tokens.
+    static uint8_t copy_buf[sizeof(json_buf)];
+    if (succeeded) {
+        int length = mu_json_compact_copy(s_tokens, n_tokens, copy_buf,
+                                          sizeof(copy_buf));
+        if (length < 0 ||
+            mu_json_parse_buffer(s_chunk_tokens, MAX_TOKENS, copy_buf, length,
+                                 NULL) != n_tokens) {
+            fprintf(stderr, "test error: mu_json_compact_copy() fails on %s\n",
+                    filename);
+            return false;
+        }
+    }
+
     return expected_outcome == succeeded;
 }
 
@@ -813,7 +912,1172 @@ void test_regression(void) {
     TEST_JSON_BAD_FMT(JSON_TEST_SUITE_DIR "n_string_single_doublequote.json");
     TEST_JSON_BAD_FMT(JSON_TEST_SUITE_DIR
                       "n_structure_close_unopened_array.json");
+
+    // mismatched close, value where a key is expected after a container
+    TEST_ASSERT_TRUE(mu_json_parse_c_str(s_tokens, MAX_TOKENS, "[1}", NULL) <
+                     0);
+    TEST_ASSERT_TRUE(
+        mu_json_parse_c_str(s_tokens, MAX_TOKENS, "{\"a\":[1], 2}", NULL) < 0);
+
+    // every level of nested containers is sliced correctly
+    TEST_ASSERT_EQUAL_INT(
+        4, mu_json_parse_c_str(s_tokens, MAX_TOKENS, "[[[[]]]]", NULL));
+    TEST_ASSERT_TRUE(mu_str_equals_cstr(&s_tokens[0].json, "[[[[]]]]"));
+    TEST_ASSERT_TRUE(mu_str_equals_cstr(&s_tokens[1].json, "[[[]]]"));
+    TEST_ASSERT_TRUE(mu_str_equals_cstr(&s_tokens[2].json, "[[]]"));
+    TEST_ASSERT_TRUE(mu_str_equals_cstr(&s_tokens[3].json, "[]"));
+}
+
+void test_json_error_info(void) {
+    mu_json_error_info_t info;
+    mu_json_parse_opts_t opts = {.error = &info};
+
+    // bad character in an object value, on the second line
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                              "{\"a\": [1,\n  2, x]}", &opts));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT, info.err);
+    TEST_ASSERT_EQUAL_INT(15, info.char_pos);
+    TEST_ASSERT_EQUAL_INT(2, info.line);
+    TEST_ASSERT_EQUAL_INT(6, info.column);
+    TEST_ASSERT_EQUAL_STRING("VA", info.state);
+    TEST_ASSERT_EQUAL_STRING("C_ETC", info.char_class);
+    TEST_ASSERT_EQUAL_INT(2, info.container); // the [ ... ] array
+    TEST_ASSERT_EQUAL_INT(MU_JSON_TOKEN_TYPE_ARRAY,
+                          mu_json_token_type(&s_tokens[info.container]));
+
+    // mismatched close
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_parse_c_str(s_tokens, MAX_TOKENS, "[1}",
+                                              &opts));
+    TEST_ASSERT_EQUAL_INT(2, info.char_pos);
+    TEST_ASSERT_EQUAL_STRING("IN", info.state);
+    TEST_ASSERT_EQUAL_STRING("C_RCURB", info.char_class);
+
+    // illegal control character
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_parse_c_str(s_tokens, MAX_TOKENS, "[\f]",
+                                              &opts));
+    TEST_ASSERT_EQUAL_INT(1, info.char_pos);
+    TEST_ASSERT_EQUAL_STRING("illegal character", info.char_class);
+
+    // unterminated input
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_INCOMPLETE,
+                          mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                              "{\"a\":[1,2]", &opts));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_INCOMPLETE, info.err);
+    TEST_ASSERT_EQUAL_INT(10, info.char_pos);
+    TEST_ASSERT_EQUAL_STRING("end of input", info.char_class);
+    TEST_ASSERT_EQUAL_INT(0, info.container);
+
+    // out of tokens
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NO_TOKENS,
+                          mu_json_parse_c_str(s_tokens, 2, "[1,2]", &opts));
+    TEST_ASSERT_EQUAL_INT(3, info.char_pos);
+
+    // success leaves the report cleared
+    TEST_ASSERT_EQUAL_INT(
+        11, mu_json_parse_c_str(s_tokens, MAX_TOKENS, s_json, &opts));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NONE, info.err);
+}
+
+void test_json_limits(void) {
+    mu_json_error_info_t info;
+    mu_json_parse_opts_t opts = {.error = &info};
+
+    // max_depth
+    opts.max_depth = 2;
+    TEST_ASSERT_EQUAL_INT(
+        4, mu_json_parse_c_str(s_tokens, MAX_TOKENS, "[{\"a\":1}]", &opts));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                              "[{\"a\":[1]}]", &opts));
+    TEST_ASSERT_EQUAL_INT(6, info.char_pos); // aborts at the third [
+    opts.max_depth = 0;
+
+    // max_string_length counts the bytes between the quotes
+    opts.max_string_length = 3;
+    TEST_ASSERT_EQUAL_INT(
+        3, mu_json_parse_c_str(s_tokens, MAX_TOKENS, "{\"abc\":\"\\\"b\"}",
+                               &opts));
+    TEST_ASSERT_TRUE(mu_str_equals_cstr(&s_tokens[2].json, "\"\\\"b\""));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                              "[\"abcdefghijklmnop", &opts));
+    TEST_ASSERT_EQUAL_INT(6, info.char_pos); // aborts just past the 4th byte
+    opts.max_string_length = 0;
+
+    // max_bytes rejects without scanning
+    opts.max_bytes = 4;
+    TEST_ASSERT_EQUAL_INT(
+        2, mu_json_parse_c_str(s_tokens, MAX_TOKENS, "[12]", &opts));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_parse_c_str(s_tokens, MAX_TOKENS, "[123]",
+                                              &opts));
+    opts.max_bytes = 0;
+
+    // without explicit limits, nesting is still capped to fit in int16_t
+    static mu_json_token_t deep_tokens[MU_JSON_MAX_DEPTH + 1];
+    int n = MU_JSON_MAX_DEPTH + 1;
+    memset(json_buf, '[', n);
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_parse_buffer(deep_tokens, n, json_buf, n,
+                                               NULL));
+}
+
+void test_json_escaped_quote(void) {
+    // an escaped quote does not begin a new string
+    TEST_ASSERT_EQUAL_INT(
+        2, mu_json_parse_c_str(s_tokens, MAX_TOKENS, "[\"a\\\"b\"]", NULL));
+    TEST_ASSERT_TRUE(mu_str_equals_cstr(&s_tokens[1].json, "\"a\\\"b\""));
+}
+
+void test_json_c_str_single_pass(void) {
+    mu_json_error_info_t info;
+    mu_json_parse_opts_t opts = {.error = &info};
+
+    // C strings are parsed up to the NUL; bytes beyond it are never examined
+    memcpy(json_buf, "[1, 2]\0garbage", 15);
+    TEST_ASSERT_EQUAL_INT(
+        3, mu_json_parse_c_str(s_tokens, MAX_TOKENS, (char *)json_buf, NULL));
+    TEST_ASSERT_TRUE(mu_str_equals_cstr(&s_tokens[0].json, "[1, 2]"));
+
+    // on an early error, open containers still extend to the end of input
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                              "[{\"a\":1] trailing", &opts));
+    TEST_ASSERT_TRUE(
+        mu_str_equals_cstr(&s_tokens[0].json, "[{\"a\":1] trailing"));
+    TEST_ASSERT_TRUE(
+        mu_str_equals_cstr(&s_tokens[1].json, "{\"a\":1] trailing"));
+    TEST_ASSERT_EQUAL_INT(7, info.char_pos);
+}
+
+void test_json_padded(void) {
+    static const char *docs[] = {
+        "\"abc\"", "\"abc", "[\"a long string, longer than a word\"]",
+        "[\"a\\\"b\"]", "{\"k\":\"v\"}", "[\"tab\there\"]", "\"\"",
+    };
+    uint8_t buf[64];
+
+    TEST_ASSERT_NULL(mu_json_pad_buffer(buf, MU_JSON_PADDING - 1,
+                                        (const uint8_t *)"", 0));
+    for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        size_t len = strlen(docs[i]);
+        TEST_ASSERT_EQUAL_PTR(buf, mu_json_pad_buffer(buf, sizeof(buf),
+                                                      (uint8_t *)docs[i], len));
+        for (size_t j = 0; j < MU_JSON_PADDING; j++) {
+            TEST_ASSERT_EQUAL_UINT8(0, buf[len + j]);
+        }
+        // The padding's contents must not matter, even if they'd continue an
+        // unterminated string.
+        memset(&buf[len], 'a', MU_JSON_PADDING);
+        TEST_ASSERT_EQUAL_INT(
+            mu_json_parse_buffer(s_tokens, MAX_TOKENS, buf, len, NULL),
+            mu_json_parse_padded(s_tokens, MAX_TOKENS, buf, len, NULL));
+    }
+}
+
+void test_json_parse_batch(void) {
+    static const char *jsons[] = {
+        "{\"a\":[1, 2.5e3], \"b\":\"str\", \"c\":null}",
+        "[1}",
+        "true",
+        "[[[[]]]]",
+        "{\"k\":\"unterminated}",
+        "",
+        "{\"id\": 1234, \"name\": \"sensor\", \"ok\": true, \"v\": [0.25]}",
+        "\"a\\\"b\"",
+        "[1, 2, 3, 4, 5, 6, 7, 8, 9, 10]",
+        "{\"a\":1,}",
+    };
+#define N_DOCS (sizeof(jsons) / sizeof(jsons[0]))
+#define DOC_TOKENS 20
+    static mu_json_token_t tokens[N_DOCS][DOC_TOKENS];
+    mu_json_batch_doc_t docs[N_DOCS];
+    size_t n_good = 0;
+
+    for (size_t i = 0; i < N_DOCS; i++) {
+        docs[i].buf = (const uint8_t *)jsons[i];
+        docs[i].buflen = strlen(jsons[i]);
+        docs[i].tokens = tokens[i];
+        docs[i].max_tokens = DOC_TOKENS;
+    }
+    size_t n_parsed = mu_json_parse_batch(docs, N_DOCS, NULL);
+
+    // each document parses exactly as it would on its own
+    for (size_t i = 0; i < N_DOCS; i++) {
+        int expected = mu_json_parse_buffer(s_tokens, MAX_TOKENS, docs[i].buf,
+                                            docs[i].buflen, NULL);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(expected, docs[i].result, jsons[i]);
+        for (int j = 0; j < expected; j++) {
+            TEST_ASSERT_EQUAL_INT(mu_json_token_type(&s_tokens[j]),
+                                  mu_json_token_type(&tokens[i][j]));
+            TEST_ASSERT_EQUAL_INT(0, mu_str_compare(&s_tokens[j].json,
+                                                    &tokens[i][j].json));
+        }
+        n_good += expected > 0;
+    }
+    TEST_ASSERT_EQUAL_INT(n_good, n_parsed);
+    TEST_ASSERT_EQUAL_INT(0, mu_json_parse_batch(docs, 0, NULL));
+#undef N_DOCS
+#undef DOC_TOKENS
+}
+
+#define VALIDATE(_cstr)                                                        \
+    mu_json_validate((const uint8_t *)(_cstr), strlen(_cstr))
+
+void test_json_parse_chunked(void) {
+    static const char *jsons[] = {
+        "[1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16]",
+        "{\"a\": [1, {\"b\": 2}], \"c\": \"x,y\", \"d\": null, "
+        "\"e\": true}",
+        // commas, brackets and escaped quotes inside strings
+        "[\",\", \"[,]\", \"\\\",\", \"\\\\\", \"{\\\"a\\\":1}\", "
+        "\",,,,\", \"]\"]",
+        // nested commas only
+        "  [[1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15]]  ",
+        "\"a scalar root, never split\"",
+        "[]",
+        "[1, 2, 3, 4, 5, 6, 7, 8,]",
+        "[1, 2, 3, 4, 5, 6, 7, 8}",
+        "{\"a\": 1, \"b\": 2, \"c\" 3, \"d\": 4, \"e\": 5}",
+        "[1, 2, 3, 4, 5, 6, 7, 8",
+        "[1, 2, 3, 4, 5, 6, 7, 8]]",
+        "[1, 2, 3, 4] [5, 6, 7, 8]",
+        "[\"unterminated, 1, 2, 3, 4, 5, 6, 7, 8]",
+    };
+    mu_json_stats_t stats;
+    mu_json_parse_opts_t opts = {0};
+
+    for (size_t i = 0; i < sizeof(jsons) / sizeof(jsons[0]); i++) {
+        const uint8_t *buf = (const uint8_t *)jsons[i];
+        size_t buflen = strlen(jsons[i]);
+        for (size_t n_chunks = 1; n_chunks <= 20; n_chunks++) {
+            TEST_ASSERT_TRUE_MESSAGE(
+                chunked_matches_serial(buf, buflen, n_chunks), jsons[i]);
+        }
+    }
+
+    // the root's elements are split evenly across chunks
+    mu_json_chunked_t chunked;
+    const uint8_t *buf = (const uint8_t *)jsons[0];
+    size_t buflen = strlen(jsons[0]);
+    size_t n_chunks = mu_json_chunked_init(&chunked, s_chunk_tokens,
+                                           MAX_TOKENS, buf, buflen, 4, NULL);
+    TEST_ASSERT_EQUAL_INT(4, n_chunks);
+    for (size_t i = 0; i < n_chunks; i++) {
+        mu_json_chunked_scan(&chunked, i);
+    }
+    TEST_ASSERT_EQUAL_INT(4, mu_json_chunked_plan(&chunked));
+    for (size_t i = 0; i < 4; i++) {
+        mu_json_chunked_parse(&chunked, i);
+    }
+    TEST_ASSERT_EQUAL_INT(17, mu_json_chunked_finish(&chunked));
+
+    // too few tokens in one chunk's share falls back to the serial parse
+    TEST_ASSERT_EQUAL_INT(17, mu_json_parse_chunked(s_chunk_tokens, 17, buf,
+                                                    buflen, 4, NULL));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NO_TOKENS,
+                          mu_json_parse_chunked(s_chunk_tokens, 16, buf,
+                                                buflen, 4, NULL));
+
+    // stats are only collected by the serial parse, so they match too
+    memset(&stats, 0, sizeof(stats));
+    opts.stats = &stats;
+    TEST_ASSERT_EQUAL_INT(17, mu_json_parse_chunked(s_chunk_tokens, MAX_TOKENS,
+                                                    buf, buflen, 4, &opts));
+#ifdef MU_JSON_STATS
+    TEST_ASSERT_EQUAL_INT(17, stats.tokens[MU_JSON_TOKEN_TYPE_INTEGER] + 1);
+#endif
+}
+
+/**
+ * @brief Assert that every struct-of-arrays navigation function agrees with
+ * its array-of-structs counterpart on each of n tokens in s_tokens.
+ */
+static void check_soa_navigation(int n) {
+    static int16_t depths[MAX_TOKENS];
+    static uint8_t types[MAX_TOKENS];
+    static uint8_t flags[MAX_TOKENS];
+    static uint32_t offsets[MAX_TOKENS];
+    static uint32_t lengths[MAX_TOKENS];
+    mu_json_soa_t soa;
+    mu_str_t slice;
+
+#define INDEX(_token) ((_token) == NULL ? -1 : (int)((_token) - s_tokens))
+    mu_json_soa_init(&soa, depths, types, flags, offsets, lengths,
+                     MAX_TOKENS);
+    TEST_ASSERT_EQUAL_INT(n, mu_json_soa_from_tokens(&soa, s_tokens, n));
+    for (int i = 0; i < n; i++) {
+        mu_json_token_t *t = &s_tokens[i];
+        TEST_ASSERT_EQUAL_INT(t->depth, depths[i]);
+        TEST_ASSERT_EQUAL_INT(t->type, types[i]);
+        TEST_ASSERT_EQUAL_INT(t->flags, flags[i]);
+        TEST_ASSERT_EQUAL_INT(0, mu_str_compare(&t->json,
+                                                mu_json_soa_slice(&soa, i,
+                                                                  &slice)));
+        TEST_ASSERT_EQUAL_INT(INDEX(mu_json_token_parent(t)),
+                              mu_json_soa_parent(&soa, i));
+        TEST_ASSERT_EQUAL_INT(INDEX(mu_json_token_child(t)),
+                              mu_json_soa_child(&soa, i));
+        TEST_ASSERT_EQUAL_INT(INDEX(mu_json_token_prev_sibling(t)),
+                              mu_json_soa_prev_sibling(&soa, i));
+        TEST_ASSERT_EQUAL_INT(INDEX(mu_json_token_next_sibling(t)),
+                              mu_json_soa_next_sibling(&soa, i));
+    }
+#undef INDEX
+    TEST_ASSERT_NULL(mu_json_soa_slice(&soa, n, &slice));
+    TEST_ASSERT_EQUAL_INT(-1, mu_json_soa_parent(&soa, -1));
+    TEST_ASSERT_EQUAL_INT(-1, mu_json_soa_next_sibling(&soa, n));
+    mu_json_soa_init(&soa, depths, types, flags, offsets, lengths, n - 1);
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NO_TOKENS,
+                          mu_json_soa_from_tokens(&soa, s_tokens, n));
+}
+
+void test_json_soa(void) {
+    int n = mu_json_parse_c_str(s_tokens, MAX_TOKENS, s_json, NULL);
+    check_soa_navigation(n);
+
+    // wide and deep subtrees, to cross several vector compares per search
+    size_t len = 0;
+    char *buf = (char *)json_buf;
+    len += sprintf(&buf[len], "[");
+    for (int i = 0; i < 5; i++) {
+        len += sprintf(&buf[len], "%s[", i == 0 ? "" : ",");
+        for (int j = 0; j < 2 + 3 * i; j++) {
+            len += sprintf(&buf[len], "%s{\"k\":[%d]}", j == 0 ? "" : ",", j);
+        }
+        len += sprintf(&buf[len], "]");
+    }
+    len += sprintf(&buf[len], "]");
+    n = mu_json_parse_buffer(s_tokens, MAX_TOKENS, json_buf, len, NULL);
+    TEST_ASSERT_TRUE(n > 100);
+    check_soa_navigation(n);
+}
+
+void test_json_doc(void) {
+    static int16_t depths[MAX_TOKENS];
+    static uint8_t types[MAX_TOKENS];
+    static uint8_t flags[MAX_TOKENS];
+    static uint32_t offsets[MAX_TOKENS];
+    static uint32_t lengths[MAX_TOKENS];
+    const uint8_t *buf = (const uint8_t *)s_json;
+    size_t buflen = strlen(s_json);
+    mu_json_stats_t stats = {0};
+    mu_json_parse_opts_t opts = {.stats = &stats};
+    mu_json_soa_t index;
+    mu_json_doc_t doc;
+
+    mu_json_doc_init(&doc, s_chunk_tokens, MAX_TOKENS);
+    TEST_ASSERT_NULL(mu_json_doc_root(&doc));
+    int n = mu_json_doc_parse(&doc, buf, buflen, &opts);
+    TEST_ASSERT_EQUAL_INT(n, mu_json_parse_buffer(s_tokens, MAX_TOKENS, buf,
+                                                  buflen, NULL));
+    TEST_ASSERT_EQUAL_INT(n, mu_json_doc_token_count(&doc));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NONE, mu_json_doc_error(&doc));
+    TEST_ASSERT_EQUAL_PTR(&stats, doc.stats);
+    TEST_ASSERT_EQUAL_PTR(&s_chunk_tokens[0], mu_json_doc_root(&doc));
+    TEST_ASSERT_NULL(mu_json_doc_token(&doc, n));
+    TEST_ASSERT_NULL(mu_json_doc_token(&doc, -1));
+    TEST_ASSERT_EQUAL_INT(-1, mu_json_doc_index_of(&doc, &s_tokens[0]));
+    TEST_ASSERT_EQUAL_INT(-1, mu_json_doc_offset_of(&doc, NULL));
+    // s_json begins "{ \"a\" : 10"
+    TEST_ASSERT_EQUAL_INT(2, mu_json_doc_offset_of(&doc, &s_chunk_tokens[1]));
+
+    // navigation agrees with the token functions, with and without an index
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < n; i++) {
+            mu_json_token_t *t = mu_json_doc_token(&doc, i);
+            TEST_ASSERT_EQUAL_INT(i, mu_json_doc_index_of(&doc, t));
+            TEST_ASSERT_EQUAL_PTR(mu_json_token_parent(t),
+                                  mu_json_doc_parent(&doc, t));
+            TEST_ASSERT_EQUAL_PTR(mu_json_token_child(t),
+                                  mu_json_doc_child(&doc, t));
+            TEST_ASSERT_EQUAL_PTR(mu_json_token_prev_sibling(t),
+                                  mu_json_doc_prev_sibling(&doc, t));
+            TEST_ASSERT_EQUAL_PTR(mu_json_token_next_sibling(t),
+                                  mu_json_doc_next_sibling(&doc, t));
+        }
+        mu_json_soa_init(&index, depths, types, flags, offsets, lengths,
+                         MAX_TOKENS);
+        TEST_ASSERT_EQUAL_INT(n, mu_json_doc_attach_index(&doc, &index));
+    }
+
+    // a failed parse leaves no tokens and records the error
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_doc_parse(&doc, (const uint8_t *)"[1}", 3,
+                                            NULL));
+    TEST_ASSERT_EQUAL_INT(0, mu_json_doc_token_count(&doc));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT, mu_json_doc_error(&doc));
+    TEST_ASSERT_NULL(mu_json_doc_root(&doc));
+    TEST_ASSERT_NULL(doc.index);
+    TEST_ASSERT_NULL(mu_json_doc_parent(&doc, &s_chunk_tokens[1]));
+}
+
+void test_json_values(void) {
+    static mu_json_value_t values[MAX_TOKENS];
+    mu_json_parse_opts_t opts = {.values = values};
+    const char *json = "[0, -7, 42, 9223372036854775807, -9223372036854775808,"
+                       " 99999999999999999999, -99999999999999999999, 1.5,"
+                       " -0.25, 6.02214076e23, 1E-3, 0.1,"
+                       " 12345678901234567890.1,"
+                       " 4.9e-324, 1e400, \"12\", true]";
+    int n = mu_json_parse_c_str(s_tokens, MAX_TOKENS, json, &opts);
+    TEST_ASSERT_EQUAL_INT(18, n);
+
+    TEST_ASSERT_EQUAL_INT64(0, values[1].i);
+    TEST_ASSERT_EQUAL_INT64(-7, values[2].i);
+    TEST_ASSERT_EQUAL_INT64(42, values[3].i);
+    TEST_ASSERT_EQUAL_INT64(INT64_MAX, values[4].i);
+    TEST_ASSERT_EQUAL_INT64(INT64_MIN, values[5].i);
+    // out of range: saturate
+    TEST_ASSERT_EQUAL_INT64(INT64_MAX, values[6].i);
+    TEST_ASSERT_EQUAL_INT64(INT64_MIN, values[7].i);
+    // doubles must be bit-exact with strtod()
+    for (int i = 8; i <= 15; i++) {
+        mu_str_t *slice = mu_json_token_slice(&s_tokens[i]);
+        char buf[40];
+        snprintf(buf, sizeof(buf), "%.*s", (int)mu_str_length(slice),
+                 mu_str_buf(slice));
+        TEST_ASSERT_EQUAL_INT(MU_JSON_TOKEN_TYPE_NUMBER,
+                              mu_json_token_type(&s_tokens[i]));
+        TEST_ASSERT_TRUE_MESSAGE(values[i].d == strtod(buf, NULL), buf);
+    }
+    TEST_ASSERT_TRUE(values[8].d == 1.5);
+    TEST_ASSERT_TRUE(values[9].d == -0.25);
+
+    // a scalar root is decoded too, and other tokens are left alone
+    values[0].i = 1234;
+    TEST_ASSERT_EQUAL_INT(1, mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                                 " -3.75e1 ", &opts));
+    TEST_ASSERT_TRUE(values[0].d == -37.5);
+    TEST_ASSERT_EQUAL_INT(1, mu_json_parse_c_str(s_tokens, MAX_TOKENS, "\"x\"",
+                                                 &opts));
+    TEST_ASSERT_TRUE(values[0].d == -37.5);
+}
+
+void test_json_typed_arrays(void) {
+    const char *json = " [ 1, -2.5,3e2 ,12345678901234567, 0.000123456789012,"
+                       "-98765432.12345678 ] ";
+    double doubles[6];
+    float floats[6];
+    int32_t ints[6];
+
+    // from tokens
+    TEST_ASSERT_EQUAL_INT(7, mu_json_parse_c_str(s_tokens, MAX_TOKENS, json,
+                                                 NULL));
+    TEST_ASSERT_EQUAL_INT(6, mu_json_array_to_doubles(s_tokens, doubles, 6));
+    for (int i = 0; i < 6; i++) {
+        mu_str_t *slice = mu_json_token_slice(&s_tokens[i + 1]);
+        char buf[40];
+        snprintf(buf, sizeof(buf), "%.*s", (int)mu_str_length(slice),
+                 mu_str_buf(slice));
+        TEST_ASSERT_TRUE_MESSAGE(doubles[i] == strtod(buf, NULL), buf);
+    }
+    TEST_ASSERT_EQUAL_INT(6, mu_json_array_to_float(s_tokens, floats, 6));
+    TEST_ASSERT_TRUE(floats[1] == -2.5f);
+    TEST_ASSERT_TRUE(floats[2] == 300.0f);
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_array_to_doubles(s_tokens, doubles, 5));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_array_to_int32(s_tokens, ints, 6));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_array_to_doubles(&s_tokens[1], doubles, 6));
+
+    // from the raw buffer: the same values, no tokens
+    double raw[6];
+    TEST_ASSERT_EQUAL_INT(6, mu_json_buffer_to_doubles((const uint8_t *)json,
+                                                       strlen(json), raw, 6));
+    TEST_ASSERT_EQUAL_MEMORY(doubles, raw, sizeof(raw));
+
+    const char *ints_json = "[0,-2147483648,2147483647,12345678]";
+    TEST_ASSERT_EQUAL_INT(4, mu_json_buffer_to_int32((const uint8_t *)ints_json,
+                                                     strlen(ints_json), ints,
+                                                     6));
+    TEST_ASSERT_EQUAL_INT32(0, ints[0]);
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, ints[1]);
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, ints[2]);
+    TEST_ASSERT_EQUAL_INT32(12345678, ints[3]);
+    TEST_ASSERT_EQUAL_INT(4, mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                                 "[1, 2, -3]", NULL));
+    TEST_ASSERT_EQUAL_INT(3, mu_json_array_to_int32(s_tokens, ints, 6));
+    TEST_ASSERT_EQUAL_INT32(-3, ints[2]);
+
+    const struct {
+        const char *json;
+        int result;
+    } cases[] = {
+        {"[]", 0},
+        {" [ ] ", 0},
+        {"[1.5e-3]", 1},
+        {"", MU_JSON_ERR_INCOMPLETE},
+        {"[1,", MU_JSON_ERR_INCOMPLETE},
+        {"[1 2]", MU_JSON_ERR_BAD_FORMAT},
+        {"[1,]", MU_JSON_ERR_BAD_FORMAT},
+        {"[01]", MU_JSON_ERR_BAD_FORMAT},
+        {"[1.]", MU_JSON_ERR_BAD_FORMAT},
+        {"[1e]", MU_JSON_ERR_BAD_FORMAT},
+        {"[.5]", MU_JSON_ERR_BAD_FORMAT},
+        {"[\"1\"]", MU_JSON_ERR_BAD_FORMAT},
+        {"[1] x", MU_JSON_ERR_BAD_FORMAT},
+        {"{}", MU_JSON_ERR_BAD_FORMAT},
+        {"[1,2,3,4,5,6,7]", MU_JSON_ERR_LIMIT},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        TEST_ASSERT_EQUAL_INT_MESSAGE(
+            cases[i].result,
+            mu_json_buffer_to_doubles((const uint8_t *)cases[i].json,
+                                      strlen(cases[i].json), raw, 6),
+            cases[i].json);
+    }
+    const uint8_t *too_big = (const uint8_t *)"[2147483648]";
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_buffer_to_int32(too_big, 12, ints, 6));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_buffer_to_int32((const uint8_t *)"[1.0]", 5,
+                                                  ints, 6));
+}
+
+void test_json_extract_columns(void) {
+    const char *json = "["
+                       "{\"t\": 1.5, \"v\": 10, \"id\": \"a\", \"ok\": true},"
+                       "{\"t\": 2.5, \"v\": 20, \"id\": \"b\", \"ok\": false},"
+                       "{\"t\": 3, \"v\": null, \"id\": \"c\", \"x\": [1, 2]},"
+                       "{\"id\": \"d\", \"t\": 4e1, \"v\": 3000000000},"
+                       "{\"id\": \"e\", \"t\": 5, \"v\": -5, \"ok\": 1}"
+                       "]";
+    double t[5];
+    int32_t v[5];
+    mu_str_t id[5];
+    bool ok[5];
+    uint8_t t_valid[1] = {0}, v_valid[1] = {0}, id_valid[1] = {0},
+            ok_valid[1] = {0};
+    mu_json_column_t columns[] = {
+        {.key = "t", .type = MU_JSON_COLUMN_DOUBLE, t, t_valid},
+        {.key = "v", .type = MU_JSON_COLUMN_INT32, v, v_valid},
+        {.key = "id", .type = MU_JSON_COLUMN_STRING, id, id_valid},
+        {.key = "ok", .type = MU_JSON_COLUMN_BOOL, ok, ok_valid},
+    };
+    mu_json_extractor_t extractor;
+
+    TEST_ASSERT_TRUE(mu_json_parse_c_str(s_tokens, MAX_TOKENS, json, NULL) > 0);
+    mu_json_extractor_init(&extractor, columns, 4, 5);
+    TEST_ASSERT_EQUAL_INT(5, mu_json_extract_columns(&extractor, s_tokens));
+
+    TEST_ASSERT_TRUE(t[0] == 1.5 && t[1] == 2.5 && t[2] == 3.0);
+    TEST_ASSERT_TRUE(t[3] == 40.0 && t[4] == 5.0);
+    TEST_ASSERT_EQUAL_HEX8(0x1f, t_valid[0]);
+    // null (row 2) and out of range (row 3) are not valid
+    TEST_ASSERT_EQUAL_INT32(10, v[0]);
+    TEST_ASSERT_EQUAL_INT32(20, v[1]);
+    TEST_ASSERT_EQUAL_INT32(0, v[2]);
+    TEST_ASSERT_EQUAL_INT32(0, v[3]);
+    TEST_ASSERT_EQUAL_INT32(-5, v[4]);
+    TEST_ASSERT_EQUAL_HEX8(0x13, v_valid[0]);
+    TEST_ASSERT_FALSE(mu_json_column_is_valid(&columns[1], 2));
+    TEST_ASSERT_TRUE(mu_json_column_is_valid(&columns[1], 4));
+    TEST_ASSERT_EQUAL_INT(0, mu_str_compare_cstr(&id[3], "\"d\""));
+    TEST_ASSERT_EQUAL_HEX8(0x1f, id_valid[0]);
+    // missing (rows 2 and 3) and not a boolean (row 4)
+    TEST_ASSERT_TRUE(ok[0]);
+    TEST_ASSERT_FALSE(ok[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x03, ok_valid[0]);
+
+    // Searches: every key of the first record, "x" in place of "ok", the
+    // three reordered keys, then "ok" in place of "x".
+    TEST_ASSERT_EQUAL_INT(4 + 1 + 3 + 1, extractor.key_searches);
+
+    // errors
+    mu_json_extractor_init(&extractor, columns, 4, 4);
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_extract_columns(&extractor, s_tokens));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_extract_columns(&extractor, &s_tokens[1]));
+    TEST_ASSERT_EQUAL_INT(3, mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                                 "[{}, 1]", NULL));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_extract_columns(&extractor, s_tokens));
+}
+
+void test_json_sparse_arrays(void) {
+    const char *json = "{\"a\": [1, 2.5, \"x\", [3, 4], {\"k\": 5}, true, 6],"
+                       " \"b\": [ ], \"c\": [7], \"d\": 8}";
+    mu_json_parse_opts_t opts = {.sparse_arrays = true};
+    double doubles[8];
+
+    // threshold 0: only containers and object members get tokens
+    TEST_ASSERT_EQUAL_INT(21, mu_json_parse_c_str(s_tokens, MAX_TOKENS, json,
+                                                  NULL));
+    TEST_ASSERT_EQUAL_INT(13, mu_json_parse_c_str(s_tokens, MAX_TOKENS, json,
+                                                  &opts));
+    TEST_ASSERT_TRUE(mu_json_token_is_last(&s_tokens[12]));
+    mu_json_token_t *a = &s_tokens[2];
+    TEST_ASSERT_EQUAL_INT(MU_JSON_TOKEN_TYPE_ARRAY, mu_json_token_type(a));
+    TEST_ASSERT_TRUE(a->flags & MU_JSON_TOKEN_FLAG_IS_SPARSE);
+    TEST_ASSERT_EQUAL_INT(0, mu_str_compare_cstr(
+                                 mu_json_token_slice(a),
+                                 "[1, 2.5, \"x\", [3, 4], {\"k\": 5}, true, 6]"));
+    TEST_ASSERT_EQUAL_INT(7, mu_json_token_element_count(a));
+    // the nested containers keep their own scalars
+    mu_json_token_t *nested = mu_json_token_child(a);
+    TEST_ASSERT_EQUAL_INT(MU_JSON_TOKEN_TYPE_ARRAY,
+                          mu_json_token_type(nested));
+    TEST_ASSERT_TRUE(nested->flags & MU_JSON_TOKEN_FLAG_IS_SPARSE);
+    TEST_ASSERT_EQUAL_INT(2, mu_json_token_element_count(nested));
+    nested = mu_json_token_next_sibling(nested);
+    TEST_ASSERT_EQUAL_INT(MU_JSON_TOKEN_TYPE_OBJECT,
+                          mu_json_token_type(nested));
+    TEST_ASSERT_EQUAL_INT(0, mu_str_compare_cstr(
+                                 mu_json_token_slice(&nested[2]), "5"));
+    TEST_ASSERT_NULL(mu_json_token_next_sibling(nested));
+    // "b": [ ] is empty, "c": [7] is sparse
+    TEST_ASSERT_EQUAL_INT(0, mu_json_token_element_count(&s_tokens[8]));
+    TEST_ASSERT_FALSE(s_tokens[8].flags & MU_JSON_TOKEN_FLAG_IS_SPARSE);
+    TEST_ASSERT_EQUAL_INT(1, mu_json_token_element_count(&s_tokens[10]));
+    TEST_ASSERT_EQUAL_INT(1, mu_json_array_to_doubles(&s_tokens[10], doubles,
+                                                      8));
+    TEST_ASSERT_TRUE(doubles[0] == 7.0);
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_array_to_doubles(a, doubles, 8));
+
+    // threshold 3: the first three tokens of "a" are kept
+    opts.sparse_array_tokens = 3;
+    TEST_ASSERT_EQUAL_INT(19, mu_json_parse_c_str(s_tokens, MAX_TOKENS, json,
+                                                  &opts));
+    TEST_ASSERT_EQUAL_INT(0, mu_str_compare_cstr(
+                                 mu_json_token_slice(&s_tokens[5]), "\"x\""));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_TOKEN_TYPE_ARRAY,
+                          mu_json_token_type(&s_tokens[6]));
+    TEST_ASSERT_EQUAL_INT(4, mu_json_token_element_count(&s_tokens[0]));
+
+    // a scalar-only array needs one token however long it is
+    opts.sparse_array_tokens = 0;
+    TEST_ASSERT_EQUAL_INT(1, mu_json_parse_c_str(s_tokens, 1,
+                                                 "[1,2,3,4,5,6,7,8]", &opts));
+    TEST_ASSERT_EQUAL_INT(8, mu_json_array_to_doubles(s_tokens, doubles, 8));
+    TEST_ASSERT_TRUE(doubles[7] == 8.0);
+    TEST_ASSERT_EQUAL_INT(8, mu_json_token_element_count(s_tokens));
+}
+
+/**
+ * @brief Return the value of the member of `object` named `key`, or NULL.
+ */
+static mu_json_token_t *find_member(mu_json_token_t *object, const char *key) {
+    mu_json_token_t *t = object ? mu_json_token_child(object) : NULL;
+    for (; t != NULL; t = mu_json_token_next_sibling(t + 1)) {
+        // the slice includes the quotes
+        mu_str_t *slice = mu_json_token_slice(t);
+        if (mu_str_length(slice) == strlen(key) + 2 &&
+            memcmp(mu_str_buf(slice) + 1, key, strlen(key)) == 0) {
+            return t + 1;
+        }
+    }
+    return NULL;
+}
+
+void test_json_projection(void) {
+    const char *json = "{\"id\": 7, \"user\": {\"name\": \"ann\","
+                       " \"tags\": [\"x\", \"y\"]}, \"items\": [{\"sku\": \"a\","
+                       " \"qty\": 1}, {\"sku\": \"b\", \"qty\": 2}], \"meta\":"
+                       " {\"deep\": [[1, {\"z\": 2}]]}, \"a/b\": null}";
+    const char *pointers[] = {"/id", "/user/name", "/items/1/sku", "/a~1b"};
+    mu_json_projection_t projection;
+    mu_json_parse_opts_t opts = {.projection = &projection};
+    mu_json_token_t *t;
+
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NONE,
+                          mu_json_projection_init(&projection, pointers, 4));
+    TEST_ASSERT_EQUAL_INT(34, mu_json_parse_c_str(s_tokens, MAX_TOKENS, json,
+                                                  NULL));
+    // root, id, user, name, items, items[1], sku and a/b, with their keys
+    TEST_ASSERT_EQUAL_INT(14, mu_json_parse_c_str(s_tokens, MAX_TOKENS, json,
+                                                  &opts));
+    TEST_ASSERT_TRUE(mu_json_token_is_last(&s_tokens[13]));
+    t = find_member(s_tokens, "id");
+    TEST_ASSERT_EQUAL_INT(0, mu_str_compare_cstr(mu_json_token_slice(t), "7"));
+    t = find_member(find_member(s_tokens, "user"), "name");
+    TEST_ASSERT_EQUAL_INT(0,
+                          mu_str_compare_cstr(mu_json_token_slice(t),
+                                              "\"ann\""));
+    TEST_ASSERT_NULL(mu_json_token_next_sibling(t));
+    t = find_member(s_tokens, "items");
+    TEST_ASSERT_EQUAL_INT(MU_JSON_TOKEN_TYPE_ARRAY, mu_json_token_type(t));
+    t = mu_json_token_child(t); // only items[1] is kept
+    TEST_ASSERT_EQUAL_INT(0, mu_str_compare_cstr(
+                                 mu_json_token_slice(t),
+                                 "{\"sku\": \"b\", \"qty\": 2}"));
+    TEST_ASSERT_NULL(mu_json_token_next_sibling(t));
+    TEST_ASSERT_EQUAL_INT(0, mu_str_compare_cstr(
+                                 mu_json_token_slice(&t[2]), "\"b\""));
+    TEST_ASSERT_NULL(find_member(s_tokens, "meta"));
+    t = find_member(s_tokens, "a/b");
+    TEST_ASSERT_EQUAL_INT(MU_JSON_TOKEN_TYPE_NULL, mu_json_token_type(t));
+
+    // the skipped "meta" borrows tokens for its open containers
+    TEST_ASSERT_EQUAL_INT(14, mu_json_parse_c_str(s_tokens, 16, json, &opts));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NO_TOKENS,
+                          mu_json_parse_c_str(s_tokens, 15, json, &opts));
+
+    // a selected container is kept whole
+    pointers[0] = "/items";
+    mu_json_projection_init(&projection, pointers, 1);
+    TEST_ASSERT_EQUAL_INT(13, mu_json_parse_c_str(s_tokens, MAX_TOKENS, json,
+                                                  &opts));
+    TEST_ASSERT_EQUAL_INT(2, mu_json_token_element_count(&s_tokens[2]));
+
+    // "" is the whole document
+    pointers[0] = "";
+    mu_json_projection_init(&projection, pointers, 1);
+    TEST_ASSERT_EQUAL_INT(34, mu_json_parse_c_str(s_tokens, MAX_TOKENS, json,
+                                                  &opts));
+
+    // skipped values are still validated
+    pointers[0] = "/id";
+    mu_json_projection_init(&projection, pointers, 1);
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                              "{\"id\": 1, \"x\": [1, }",
+                                              &opts));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_INCOMPLETE,
+                          mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                              "{\"id\": 1, \"x\": [1",
+                                              &opts));
+
+    // malformed pointers
+    pointers[0] = "id";
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_projection_init(&projection, pointers, 1));
+    pointers[0] = "/a~2";
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_projection_init(&projection, pointers, 1));
+    pointers[0] = "/1/2/3/4/5/6/7/8/9";
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_projection_init(&projection, pointers, 1));
+}
+
+/**
+ * @brief Compaction predicate: drop "drop" strings and the "blob" member.
+ */
+static bool keep_token(mu_json_token_t *token, void *arg) {
+    (void)arg;
+    if (mu_str_compare_cstr(mu_json_token_slice(token), "\"drop\"") == 0) {
+        return false;
+    }
+    return !(mu_json_token_depth(token) == 1 &&
+             mu_str_compare_cstr(mu_json_token_slice(token - 1),
+                                 "\"blob\"") == 0);
+}
+
+void test_json_compact(void) {
+    static const char json[] = "{\"id\": 7, \"blob\": {\"x\": [1, 2, 3]},"
+                               " \"list\": [1, \"drop\", {\"k\": \"drop\"}, 4],"
+                               " \"s\": \"keep\"}";
+    const char *copied = "{\"id\":7,\"list\":[1,{},4],\"s\":\"keep\"}";
+    uint8_t buf[64];
+
+    TEST_ASSERT_EQUAL_INT(20, mu_json_parse_c_str(s_tokens, MAX_TOKENS, json,
+                                                  NULL));
+    TEST_ASSERT_EQUAL_INT(10, mu_json_compact(s_tokens, 20, keep_token, NULL));
+    TEST_ASSERT_TRUE(mu_json_token_is_first(&s_tokens[0]));
+    TEST_ASSERT_TRUE(mu_json_token_is_last(&s_tokens[9]));
+    TEST_ASSERT_FALSE(mu_json_token_is_last(&s_tokens[8]));
+    mu_json_token_t *list = mu_json_token_next_sibling(&s_tokens[2]);
+    TEST_ASSERT_EQUAL_INT(0, mu_str_compare_cstr(mu_json_token_slice(list),
+                                                 "\"list\""));
+    list += 1;
+    TEST_ASSERT_EQUAL_INT(MU_JSON_TOKEN_TYPE_ARRAY, mu_json_token_type(list));
+    mu_json_token_t *t = mu_json_token_next_sibling(mu_json_token_child(list));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_TOKEN_TYPE_OBJECT, mu_json_token_type(t));
+    TEST_ASSERT_NULL(mu_json_token_child(t));
+    t = mu_json_token_next_sibling(t);
+    TEST_ASSERT_EQUAL_INT(0, mu_str_compare_cstr(mu_json_token_slice(t), "4"));
+    TEST_ASSERT_NULL(mu_json_token_next_sibling(t));
+    // slices still refer to the input
+    TEST_ASSERT_EQUAL_PTR(json, mu_str_buf(mu_json_token_slice(s_tokens)));
+
+    // copy what's left, then parse the copy: the tokens must agree
+    TEST_ASSERT_EQUAL_INT(strlen(copied),
+                          mu_json_compact_copy(s_tokens, 10, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_compact_copy(s_tokens, 10, buf, 10));
+    TEST_ASSERT_EQUAL_PTR(json, mu_str_buf(mu_json_token_slice(s_tokens)));
+    TEST_ASSERT_EQUAL_INT(strlen(copied),
+                          mu_json_compact_copy(s_tokens, 10, buf,
+                                               sizeof(buf)));
+    TEST_ASSERT_EQUAL_MEMORY(copied, buf, strlen(copied));
+    TEST_ASSERT_EQUAL_INT(10, mu_json_parse_buffer(s_chunk_tokens, MAX_TOKENS,
+                                                   buf, strlen(copied), NULL));
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_INT(s_chunk_tokens[i].type, s_tokens[i].type);
+        TEST_ASSERT_EQUAL_INT(s_chunk_tokens[i].depth, s_tokens[i].depth);
+        TEST_ASSERT_EQUAL_PTR(mu_str_buf(&s_chunk_tokens[i].json),
+                              mu_str_buf(&s_tokens[i].json));
+        TEST_ASSERT_EQUAL_INT(mu_str_length(&s_chunk_tokens[i].json),
+                              mu_str_length(&s_tokens[i].json));
+    }
+
+    // a sparse array is copied as written
+    mu_json_parse_opts_t opts = {.sparse_arrays = true};
+    copied = "{\"a\":[1, 2, [3]],\"b\":5}";
+    TEST_ASSERT_EQUAL_INT(6, mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                                 "{\"a\": [1, 2, [3]], "
+                                                 "\"b\": 5}",
+                                                 &opts));
+    TEST_ASSERT_EQUAL_INT(strlen(copied),
+                          mu_json_compact_copy(s_tokens, 6, buf,
+                                               sizeof(buf)));
+    TEST_ASSERT_EQUAL_MEMORY(copied, buf, strlen(copied));
+    TEST_ASSERT_EQUAL_PTR(&buf[12], mu_str_buf(&s_tokens[3].json));
+    TEST_ASSERT_EQUAL_INT(0, mu_str_compare_cstr(&s_tokens[3].json, "[3]"));
+    TEST_ASSERT_EQUAL_INT(3, mu_json_token_element_count(&s_tokens[2]));
+
+    // any whitespace may come between a key and its colon
+    TEST_ASSERT_EQUAL_INT(5, mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                                 "{\"a\"\n: \"drop\", "
+                                                 "\"b\": 2}",
+                                                 NULL));
+    TEST_ASSERT_EQUAL_INT(3, mu_json_compact(s_tokens, 5, keep_token, NULL));
+    TEST_ASSERT_EQUAL_INT(0, mu_str_compare_cstr(&s_tokens[1].json, "\"b\""));
+    copied = "{\"a\":1,\"b\":[2]}";
+    TEST_ASSERT_EQUAL_INT(6, mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                                 "{\"a\"\r\n: 1, "
+                                                 "\"b\"\t:[2]}",
+                                                 NULL));
+    TEST_ASSERT_EQUAL_INT(strlen(copied),
+                          mu_json_compact_copy(s_tokens, 6, buf,
+                                               sizeof(buf)));
+    TEST_ASSERT_EQUAL_MEMORY(copied, buf, strlen(copied));
+
+    // a number's slice ends before any whitespace that follows it
+    static const char *const numbers[][2] = {
+        {"[1.5\n]", "[1.5]"}, {"[0\t]", "[0]"}, {"[1e5\r\n]", "[1e5]"},
+        {"{\"a\": [1.5\n], \"b\": 2.0\n}", "{\"a\":[1.5],\"b\":2.0}"},
+    };
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+        int n = mu_json_parse_c_str(s_tokens, MAX_TOKENS, numbers[i][0], NULL);
+        TEST_ASSERT_EQUAL_INT(strlen(numbers[i][1]),
+                              mu_json_compact_copy(s_tokens, n, buf,
+                                                   sizeof(buf)));
+        TEST_ASSERT_EQUAL_MEMORY(numbers[i][1], buf, strlen(numbers[i][1]));
+    }
+
+    // rejecting the root leaves nothing
+    TEST_ASSERT_EQUAL_INT(1, mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                                 "\"drop\"", NULL));
+    TEST_ASSERT_EQUAL_INT(0, mu_json_compact(s_tokens, 1, keep_token, NULL));
+}
+
+void test_json_array_index(void) {
+    static char json[2048];
+    int32_t entries[32];
+    mu_json_array_index_t index;
+    size_t len = 0;
+
+    // [{"i": 0, "v": [0]}, {"i": 1, "v": [1]}, ...]: elements of 6 tokens
+    len += snprintf(&json[len], sizeof(json) - len, "[");
+    for (int i = 0; i < 30; i++) {
+        len += snprintf(&json[len], sizeof(json) - len,
+                        "%s{\"i\": %d, \"v\": [%d]}", i ? ", " : "", i, i);
+    }
+    snprintf(&json[len], sizeof(json) - len, "]");
+    TEST_ASSERT_EQUAL_INT(181, mu_json_parse_c_str(s_tokens, MAX_TOKENS, json,
+                                                   NULL));
+
+    // large enough for every element, and small enough to need sampling
+    static const size_t budgets[] = {32, 30, 8, 1, 0};
+    for (size_t b = 0; b < sizeof(budgets) / sizeof(budgets[0]); b++) {
+        mu_json_array_index_init(&index, entries, budgets[b]);
+        TEST_ASSERT_EQUAL_INT(30, mu_json_array_index_build(&index,
+                                                             s_tokens));
+        TEST_ASSERT_TRUE(index.n_entries <= budgets[b]);
+        mu_json_token_t *element = mu_json_token_child(s_tokens);
+        for (int i = 0; i < 30; i++) {
+            TEST_ASSERT_EQUAL_PTR(element,
+                                  mu_json_array_index_get(&index, s_tokens, i));
+            element = mu_json_token_next_sibling(element);
+        }
+        TEST_ASSERT_NULL(mu_json_array_index_get(&index, s_tokens, 30));
+        TEST_ASSERT_NULL(mu_json_array_index_get(&index, s_tokens, -1));
+    }
+    mu_json_array_index_init(&index, entries, 8);
+    mu_json_array_index_build(&index, s_tokens);
+    TEST_ASSERT_EQUAL_INT(2, index.shift); // every 4th element: 8 entries
+    TEST_ASSERT_EQUAL_INT(8, index.n_entries);
+
+    // indexed lazily, and re-indexed when asked about another array
+    mu_json_array_index_init(&index, entries, 32);
+    mu_json_token_t *v = &s_tokens[1 + 6 * 12 + 4]; // [12]
+    TEST_ASSERT_EQUAL_INT(0, mu_str_compare_cstr(mu_json_token_slice(v),
+                                                 "[12]"));
+    TEST_ASSERT_EQUAL_PTR(&v[1], mu_json_array_index_get(&index, v, 0));
+    TEST_ASSERT_EQUAL_PTR(v, index.array);
+    TEST_ASSERT_NULL(mu_json_array_index_get(&index, v, 1));
+    TEST_ASSERT_EQUAL_PTR(&s_tokens[1 + 6 * 29],
+                          mu_json_array_index_get(&index, s_tokens, 29));
+    TEST_ASSERT_EQUAL_PTR(s_tokens, index.array);
+
+    // only arrays with a token per element can be indexed
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_array_index_build(&index, &s_tokens[1]));
+    TEST_ASSERT_NULL(mu_json_array_index_get(&index, &s_tokens[1], 0));
+    mu_json_parse_opts_t opts = {.sparse_arrays = true};
+    mu_json_parse_c_str(s_tokens, MAX_TOKENS, "[1, 2]", &opts);
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_array_index_build(&index, s_tokens));
+    TEST_ASSERT_EQUAL_INT(1, mu_json_parse_c_str(s_tokens, MAX_TOKENS, "[]",
+                                                 NULL));
+    TEST_ASSERT_EQUAL_INT(0, mu_json_array_index_build(&index, s_tokens));
+    TEST_ASSERT_NULL(mu_json_array_index_get(&index, s_tokens, 0));
+}
+
+/**
+ * @brief JSONPath callback: collect up to 8 matches.
+ */
+typedef struct {
+    mu_json_token_t *matches[8];
+    int n;
+} path_matches_t;
+
+static bool collect_match(mu_json_token_t *match, void *arg) {
+    path_matches_t *m = (path_matches_t *)arg;
+    m->matches[m->n++] = match;
+    return m->n < 8;
+}
+
+/**
+ * @brief Compile and evaluate `expr` over s_tokens, and return the matches'
+ * slices joined by spaces.
+ */
+static const char *query(const char *expr) {
+    static char result[256];
+    mu_json_path_t path;
+    path_matches_t m = {.n = 0};
+    size_t len = 0;
+
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NONE, mu_json_path_compile(&path, expr));
+    mu_json_path_eval(&path, s_tokens, collect_match, &m);
+    result[0] = '\0';
+    for (int i = 0; i < m.n; i++) {
+        mu_str_t *slice = mu_json_token_slice(m.matches[i]);
+        len += snprintf(&result[len], sizeof(result) - len, "%s%.*s",
+                        i ? " " : "", (int)mu_str_length(slice),
+                        mu_str_buf(slice));
+    }
+    return result;
+}
+
+void test_json_path(void) {
+    const char *json =
+        "{\"site\": \"north\", \"devices\": ["
+        "{\"id\": 1, \"readings\": [{\"type\": \"temp\", \"value\": 20.5},"
+        " {\"type\": \"rh\", \"value\": 40}]},"
+        "{\"id\": 2, \"on\": false, \"readings\": [{\"type\": \"temp\","
+        " \"value\": -3}]},"
+        "{\"id\": 3, \"readings\": []}]}";
+    mu_json_path_t path;
+
+    TEST_ASSERT_TRUE(mu_json_parse_c_str(s_tokens, MAX_TOKENS, json, NULL) >
+                     0);
+    TEST_ASSERT_EQUAL_STRING("\"north\"", query("$.site"));
+    TEST_ASSERT_EQUAL_STRING("\"north\"", query("$['site']"));
+    TEST_ASSERT_EQUAL_STRING("2", query("$.devices[1].id"));
+    TEST_ASSERT_EQUAL_STRING("", query("$.devices[3].id"));
+    TEST_ASSERT_EQUAL_STRING("1 2 3", query("$.devices[*].id"));
+    TEST_ASSERT_EQUAL_STRING("20.5 -3",
+                             query("$.devices[*].readings"
+                                   "[?(@.type==\"temp\")].value"));
+    TEST_ASSERT_EQUAL_STRING("20.5 40 -3", query("$..value"));
+    TEST_ASSERT_EQUAL_STRING("\"rh\"",
+                             query("$..readings[?(@.value >= 21)].type"));
+    TEST_ASSERT_EQUAL_STRING("\"temp\" \"temp\"",
+                             query("$..readings[?(@.value < 30)].type"));
+    TEST_ASSERT_EQUAL_STRING("2", query("$.devices[?(@.on)].id"));
+    TEST_ASSERT_EQUAL_STRING("2", query("$.devices[?(@.on == false)].id"));
+    TEST_ASSERT_EQUAL_STRING("1 3", query("$.devices[?(@.id != 2)].id"));
+    TEST_ASSERT_EQUAL_STRING("3", query("$.devices[?(@.id > 2.5)].id"));
+    TEST_ASSERT_EQUAL_STRING("\"temp\" \"rh\" \"temp\"", query("$..type"));
+
+    // the callback can stop early; a NULL callback only counts
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NONE,
+                          mu_json_path_compile(&path, "$..*"));
+    TEST_ASSERT_EQUAL_INT(21, mu_json_path_eval(&path, s_tokens, NULL, NULL));
+    path_matches_t m = {.n = 0};
+    TEST_ASSERT_EQUAL_INT(8, mu_json_path_eval(&path, s_tokens, collect_match,
+                                               &m));
+
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_path_compile(&path, "devices"));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_path_compile(&path, "$.devices["));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_path_compile(&path, "$[?(@.a < \"x\")]"));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_path_compile(&path, "$[?(@.a == )]"));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_path_compile(&path, "$[?(@.a.b.c.d.e)]"));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_path_compile(&path, "$.a.a.a.a.a.a.a.a"
+                                                      ".a.a.a.a.a.a.a.a.a"));
+
+    // keys are found whatever whitespace comes before their colons
+    TEST_ASSERT_TRUE(mu_json_parse_c_str(s_tokens, MAX_TOKENS,
+                                         "{\"a\"\n: 1, \"b\"\t: "
+                                         "{\"a\"\r\n: 2}}",
+                                         NULL) > 0);
+    TEST_ASSERT_EQUAL_STRING("1 2", query("$..a"));
+    TEST_ASSERT_EQUAL_STRING("1 {\"a\"\r\n: 2} 2", query("$..*"));
+}
+
+static bool collect_record(mu_str_t *record, void *arg) {
+    char *ids = (char *)arg;
+    // each test record starts {"id":N
+    size_t n = strlen(ids);
+    ids[n] = mu_str_buf(record)[6];
+    ids[n + 1] = '\0';
+    return n < 2; // stop after the third match
+}
+
+void test_json_filter(void) {
+    const char *ndjson =
+        "{\"id\":1,\"level\":\"error\",\"ms\":12,\"tags\":[\"a\"]}\n"
+        "{\"id\":2,\"level\":\"info\",\"ms\":900}\n"
+        "{\"id\":3,\"msg\":\"error\",\"level\":\"warn\",\"ms\":700}\n"
+        "\n"
+        "{\"id\":4,\"level\":\"error\",\"ms\":950,\"tags\":[\"b\",\"c\"]}\r\n"
+        "{\"id\":5,\"level\":\"error\",\"ms\":\"slow\"}\n"
+        "{\"id\":6,\"level\":\"error\",\"ms\":5000,\"tags\":[]}";
+    const uint8_t *buf = (const uint8_t *)ndjson;
+    size_t buflen = strlen(ndjson);
+    mu_json_filter_predicate_t errors[] = {
+        {.pointer = "/level",
+         .op = MU_JSON_FILTER_EQUALS,
+         .value = "\"error\""},
+    };
+    mu_json_filter_predicate_t slow_errors[] = {
+        {.pointer = "/level",
+         .op = MU_JSON_FILTER_EQUALS,
+         .value = "\"error\""},
+        {.pointer = "/ms", .op = MU_JSON_FILTER_RANGE, .min = 500, .max = 1e6},
+    };
+    mu_json_filter_predicate_t tagged[] = {
+        {.pointer = "/tags/0", .op = MU_JSON_FILTER_EXISTS},
+    };
+    mu_json_filter_predicate_t too_many[MU_JSON_PROJECT_MAX_POINTERS + 1];
+    mu_json_filter_t filter;
+    char ids[8] = "";
+
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NONE,
+                          mu_json_filter_init(&filter, errors, 1, s_tokens, 8));
+    TEST_ASSERT_EQUAL_INT(4, mu_json_filter_ndjson(&filter, buf, buflen, NULL,
+                                                   NULL));
+    // record 3 has both needles but fails once parsed; 2 was never parsed
+    TEST_ASSERT_EQUAL_INT(5, filter.parsed);
+    TEST_ASSERT_EQUAL_INT(3, mu_json_filter_ndjson(&filter, buf, buflen,
+                                                   collect_record, ids));
+    TEST_ASSERT_EQUAL_STRING("145", ids);
+
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NONE,
+                          mu_json_filter_init(&filter, slow_errors, 2, s_tokens,
+                                              8));
+    ids[0] = '\0';
+    TEST_ASSERT_EQUAL_INT(2, mu_json_filter_ndjson(&filter, buf, buflen,
+                                                   collect_record, ids));
+    TEST_ASSERT_EQUAL_STRING("46", ids);
+    TEST_ASSERT_FALSE(mu_json_filter_match(&filter, buf, 20));
+
+    // a field that may be an array element needs a whole parse
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NONE,
+                          mu_json_filter_init(&filter, tagged, 1, s_tokens,
+                                              MAX_TOKENS));
+    ids[0] = '\0';
+    TEST_ASSERT_EQUAL_INT(2, mu_json_filter_ndjson(&filter, buf, buflen,
+                                                   collect_record, ids));
+    TEST_ASSERT_EQUAL_STRING("14", ids);
+    TEST_ASSERT_EQUAL_INT(1, filter.failed); // the blank line
+
+    // records that don't fit in the tokens are counted, not matched
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NONE,
+                          mu_json_filter_init(&filter, tagged, 1, s_tokens,
+                                              10));
+    TEST_ASSERT_EQUAL_INT(1, mu_json_filter_ndjson(&filter, buf, buflen, NULL,
+                                                   NULL));
+    TEST_ASSERT_EQUAL_INT(1, filter.no_tokens); // record 4 needs 11
+    TEST_ASSERT_EQUAL_INT(2, filter.failed);
+
+    errors[0].value = NULL;
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT,
+                          mu_json_filter_init(&filter, errors, 1, s_tokens, 8));
+    for (int i = 0; i < MU_JSON_PROJECT_MAX_POINTERS + 1; i++) {
+        too_many[i] = tagged[0];
+    }
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_filter_init(&filter, too_many,
+                                              MU_JSON_PROJECT_MAX_POINTERS + 1,
+                                              s_tokens, 8));
+}
+
+void test_json_validate(void) {
+    static uint8_t deep[MU_JSON_VALIDATE_MAX_DEPTH + 1];
+
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NONE, VALIDATE(s_json));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NONE, VALIDATE("[\"a\\\"b\", 1e3]"));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_NONE, VALIDATE(" \"abc\" "));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT, VALIDATE(""));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT, VALIDATE("[1}"));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT, VALIDATE("{\"a\":[1], 2}"));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT, VALIDATE("[\"a\tb\"]"));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_BAD_FORMAT, VALIDATE("\"abc"));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_INCOMPLETE, VALIDATE("[\"abc"));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_INCOMPLETE, VALIDATE("{\"a\":[1]"));
+
+    // nesting deeper than MU_JSON_VALIDATE_MAX_DEPTH is rejected
+    memset(deep, '[', sizeof(deep));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_INCOMPLETE,
+                          mu_json_validate(deep, sizeof(deep) - 1));
+    TEST_ASSERT_EQUAL_INT(MU_JSON_ERR_LIMIT,
+                          mu_json_validate(deep, sizeof(deep)));
+}
+
+#ifdef MU_JSON_STATS
+void test_json_stats(void) {
+    mu_json_stats_t stats;
+    mu_json_parse_opts_t opts = {.stats = &stats};
+
+    memset(&stats, 0, sizeof(stats));
+    //   "{ \"a\" : 10 , \"b\" : 11 , \"c\" : [ 3, 4.5 ], \"d\" : [ ] } ";
+    TEST_ASSERT_EQUAL_INT(
+        11, mu_json_parse_c_str(s_tokens, MAX_TOKENS, s_json, &opts));
+    TEST_ASSERT_EQUAL_INT(strlen(s_json) + 1, stats.bytes); // includes eos
+    TEST_ASSERT_EQUAL_INT(1, stats.tokens[MU_JSON_TOKEN_TYPE_OBJECT]);
+    TEST_ASSERT_EQUAL_INT(2, stats.tokens[MU_JSON_TOKEN_TYPE_ARRAY]);
+    TEST_ASSERT_EQUAL_INT(4, stats.tokens[MU_JSON_TOKEN_TYPE_STRING]);
+    TEST_ASSERT_EQUAL_INT(3, stats.tokens[MU_JSON_TOKEN_TYPE_INTEGER]);
+    TEST_ASSERT_EQUAL_INT(1, stats.tokens[MU_JSON_TOKEN_TYPE_NUMBER]);
+    TEST_ASSERT_EQUAL_INT(2, stats.max_depth);
+    TEST_ASSERT_TRUE(stats.transitions > 0);
+    TEST_ASSERT_TRUE(stats.lookups > 0);
+
+    // counters are indexed by action name
+    for (int i = 0; i < MU_JSON_STATS_N_ACTIONS; i++) {
+        const char *name = mu_json_stats_action_name(i);
+        if (strcmp(name, "Ba") == 0) {
+            TEST_ASSERT_EQUAL_INT(2, stats.actions[i]);
+        } else if (strcmp(name, "Pm") == 0) {
+            TEST_ASSERT_EQUAL_INT(4, stats.actions[i]);
+        } else if (strcmp(name, "Pq") == 0) {
+            TEST_ASSERT_EQUAL_INT(4, stats.actions[i]);
+        }
+    }
+    TEST_ASSERT_NULL(mu_json_stats_action_name(MU_JSON_STATS_N_ACTIONS));
+
+    // counters accumulate across calls
+    TEST_ASSERT_EQUAL_INT(
+        11, mu_json_parse_c_str(s_tokens, MAX_TOKENS, s_json, &opts));
+    TEST_ASSERT_EQUAL_INT(8, stats.tokens[MU_JSON_TOKEN_TYPE_STRING]);
+    TEST_ASSERT_EQUAL_INT(2, stats.max_depth);
 }
+#endif
 
 int main(void) {
     UNITY_BEGIN();
@@ -834,6 +2098,28 @@ int main(void) {
     RUN_TEST(test_json_check_good_format);
     RUN_TEST(test_json_check_bad_format);
     RUN_TEST(test_rfc_7159);
+    RUN_TEST(test_json_error_info);
+    RUN_TEST(test_json_limits);
+    RUN_TEST(test_json_escaped_quote);
+    RUN_TEST(test_json_c_str_single_pass);
+    RUN_TEST(test_json_padded);
+    RUN_TEST(test_json_parse_batch);
+    RUN_TEST(test_json_parse_chunked);
+    RUN_TEST(test_json_soa);
+    RUN_TEST(test_json_doc);
+    RUN_TEST(test_json_values);
+    RUN_TEST(test_json_typed_arrays);
+    RUN_TEST(test_json_extract_columns);
+    RUN_TEST(test_json_sparse_arrays);
+    RUN_TEST(test_json_projection);
+    RUN_TEST(test_json_compact);
+    RUN_TEST(test_json_array_index);
+    RUN_TEST(test_json_path);
+    RUN_TEST(test_json_filter);
+    RUN_TEST(test_json_validate);
+#ifdef MU_JSON_STATS
+    RUN_TEST(test_json_stats);
+#endif
 
     return UNITY_END();
 }
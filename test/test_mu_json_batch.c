@@ -0,0 +1,159 @@
+/**
+ * @file test_mu_json_batch.c
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 R. D. Poor <rdpoor # gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "fff.h"
+#include "mu_json_batch.h"
+#include "unity.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+DEFINE_FFF_GLOBALS;
+
+#define N_JOBS 2000 // more than all queues hold, to exercise a full pool
+#define JOB_TOKENS 20
+
+static const char *s_jsons[] = {
+    "{\"a\":[1, 2.5e3], \"b\":\"str\", \"c\":null}",
+    "[1}",
+    "true",
+    "[[[[]]]]",
+    "{\"k\":\"unterminated}",
+    "",
+    "[1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20]",
+};
+#define N_JSONS (sizeof(s_jsons) / sizeof(s_jsons[0]))
+
+static mu_json_batch_t s_batch;
+static mu_json_batch_job_t s_jobs[N_JOBS];
+static mu_json_token_t s_job_tokens[N_JOBS][JOB_TOKENS];
+static mu_json_token_t s_tokens[JOB_TOKENS + 1];
+static atomic_int s_callbacks;
+static atomic_int s_mismatches;
+
+void setUp(void) {
+    atomic_store(&s_callbacks, 0);
+    atomic_store(&s_mismatches, 0);
+}
+
+void tearDown(void) {
+    // nothing yet
+}
+
+static void on_parsed(mu_json_batch_job_t *job) {
+    // context holds the job's serial result
+    if (job->doc.result != *(int *)job->context) {
+        atomic_fetch_add(&s_mismatches, 1);
+    }
+    atomic_fetch_add(&s_callbacks, 1);
+}
+
+static void run_jobs(int n_workers) {
+    static int expected[N_JSONS];
+
+    for (size_t i = 0; i < N_JSONS; i++) {
+        expected[i] = mu_json_parse_buffer(s_tokens, JOB_TOKENS,
+                                           (const uint8_t *)s_jsons[i],
+                                           strlen(s_jsons[i]), NULL);
+    }
+    TEST_ASSERT_TRUE(mu_json_batch_init(&s_batch, n_workers));
+    for (int i = 0; i < N_JOBS; i++) {
+        mu_json_batch_job_t *job = &s_jobs[i];
+        const char *json = s_jsons[i % N_JSONS];
+        memset(job, 0, sizeof(*job));
+        job->doc.buf = (const uint8_t *)json;
+        job->doc.buflen = strlen(json);
+        job->doc.tokens = s_job_tokens[i];
+        job->doc.max_tokens = JOB_TOKENS;
+        job->callback = on_parsed;
+        job->context = &expected[i % N_JSONS];
+        while (!mu_json_batch_submit(&s_batch, job)) {
+            // every queue is full: let the workers catch up
+            mu_json_batch_wait(&s_batch);
+        }
+    }
+    mu_json_batch_wait(&s_batch);
+    TEST_ASSERT_EQUAL_INT(N_JOBS, atomic_load(&s_callbacks));
+    TEST_ASSERT_EQUAL_INT(0, atomic_load(&s_mismatches));
+
+    // tokens match the serial parse too
+    for (int i = 0; i < N_JOBS; i++) {
+        int n = expected[i % N_JSONS];
+        mu_json_parse_buffer(s_tokens, JOB_TOKENS, s_jobs[i].doc.buf,
+                             s_jobs[i].doc.buflen, NULL);
+        for (int j = 0; j < n; j++) {
+            TEST_ASSERT_EQUAL_INT(0, mu_str_compare(&s_tokens[j].json,
+                                                    &s_job_tokens[i][j].json));
+        }
+    }
+    mu_json_batch_deinit(&s_batch);
+}
+
+void test_batch_init(void) {
+    TEST_ASSERT_FALSE(mu_json_batch_init(&s_batch, 0));
+    TEST_ASSERT_FALSE(
+        mu_json_batch_init(&s_batch, MU_JSON_BATCH_MAX_WORKERS + 1));
+    TEST_ASSERT_TRUE(mu_json_batch_init(&s_batch, 2));
+    mu_json_batch_wait(&s_batch); // nothing submitted
+    mu_json_batch_deinit(&s_batch);
+}
+
+void test_batch_one_worker(void) {
+    run_jobs(1);
+}
+
+void test_batch_many_workers(void) {
+    run_jobs(4);
+}
+
+void test_batch_deinit_drains(void) {
+    // jobs still queued at deinit are parsed before the workers stop
+    TEST_ASSERT_TRUE(mu_json_batch_init(&s_batch, 3));
+    for (int i = 0; i < 100; i++) {
+        mu_json_batch_job_t *job = &s_jobs[i];
+        memset(job, 0, sizeof(*job));
+        job->doc.buf = (const uint8_t *)s_jsons[0];
+        job->doc.buflen = strlen(s_jsons[0]);
+        job->doc.tokens = s_job_tokens[i];
+        job->doc.max_tokens = JOB_TOKENS;
+        TEST_ASSERT_TRUE(mu_json_batch_submit(&s_batch, job));
+    }
+    mu_json_batch_deinit(&s_batch);
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_EQUAL_INT(9, s_jobs[i].doc.result);
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_batch_init);
+    RUN_TEST(test_batch_one_worker);
+    RUN_TEST(test_batch_many_workers);
+    RUN_TEST(test_batch_deinit_drains);
+
+    return UNITY_END();
+}
@@ -0,0 +1,250 @@
+/**
+ * @file test_mu_json_scaling.c
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 R. D. Poor <rdpoor # gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Guard against super-linear parse times on pathological inputs.
+ *
+ * Each test generates a small and a large (SCALE times bigger) instance of a
+ * pathological JSON document -- very wide objects and arrays, deep nesting,
+ * long strings and long numbers -- and parses both.  The large document is
+ * parsed SCALE times fewer than the small one so both runs touch the same
+ * number of bytes.  If parsing is linear, the two runs take about the same
+ * time; if it's quadratic, the large run takes about SCALE times longer.
+ */
+
+#include "fff.h"
+#include "mu_json.h"
+#include "mu_str.h"
+#include "unity.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+
+DEFINE_FFF_GLOBALS;
+
+#define SCALE 16           // large document is SCALE times the small one
+#define MAX_RATIO 4.0      // allowed slowdown per byte, large vs small
+#define N_TRIALS 3         // take the best of N_TRIALS timings
+#define LARGE_REPS 4       // number of times the large document is parsed
+#define MAX_ELEMENTS 65536 // elements in the largest generated document
+#define MAX_DEPTH 16384    // deepest generated nesting (must fit in int16_t)
+
+#define MAX_JSON_STRING (MAX_ELEMENTS * 8)
+#define MAX_TOKENS (MAX_ELEMENTS * 2 + 1)
+
+static uint8_t s_json[MAX_JSON_STRING];
+static mu_json_token_t s_tokens[MAX_TOKENS];
+
+/**
+ * @brief Signature for a document generator.
+ *
+ * Write a document with n elements into buf, set *n_tokens to the number of
+ * tokens the document should parse into, and return the document's length.
+ */
+typedef size_t (*generator_t)(uint8_t *buf, int n, int *n_tokens);
+
+void setUp(void) {
+    // Reset all faked functions
+}
+
+void tearDown(void) {
+    // nothing yet
+}
+
+static size_t append(uint8_t *buf, size_t len, const char *cstr) {
+    while (*cstr) {
+        buf[len++] = *cstr++;
+    }
+    return len;
+}
+
+// [0,0,0,...,0]
+static size_t gen_wide_array(uint8_t *buf, int n, int *n_tokens) {
+    size_t len = append(buf, 0, "[");
+    for (int i = 0; i < n; i++) {
+        len = append(buf, len, i == 0 ? "0" : ",0");
+    }
+    *n_tokens = n + 1;
+    return append(buf, len, "]");
+}
+
+// {"k":0,"k":0,...,"k":0}
+static size_t gen_wide_object(uint8_t *buf, int n, int *n_tokens) {
+    size_t len = append(buf, 0, "{");
+    for (int i = 0; i < n; i++) {
+        len = append(buf, len, i == 0 ? "\"k\":0" : ",\"k\":0");
+    }
+    *n_tokens = 2 * n + 1;
+    return append(buf, len, "}");
+}
+
+// [{},{},...,{}]
+static size_t gen_wide_containers(uint8_t *buf, int n, int *n_tokens) {
+    size_t len = append(buf, 0, "[");
+    for (int i = 0; i < n; i++) {
+        len = append(buf, len, i == 0 ? "{}" : ",{}");
+    }
+    *n_tokens = n + 1;
+    return append(buf, len, "]");
+}
+
+// {"k":{"k":...{}...}}
+static size_t gen_deep_objects(uint8_t *buf, int n, int *n_tokens) {
+    size_t len = 0;
+    for (int i = 0; i < n; i++) {
+        len = append(buf, len, "{\"k\":");
+    }
+    len = append(buf, len, "0");
+    for (int i = 0; i < n; i++) {
+        len = append(buf, len, "}");
+    }
+    *n_tokens = 2 * n + 1;
+    return len;
+}
+
+// [[[...]]]
+static size_t gen_deep_arrays(uint8_t *buf, int n, int *n_tokens) {
+    size_t len = 0;
+    for (int i = 0; i < n; i++) {
+        len = append(buf, len, "[");
+    }
+    for (int i = 0; i < n; i++) {
+        len = append(buf, len, "]");
+    }
+    *n_tokens = n;
+    return len;
+}
+
+// "aaaa...a"
+static size_t gen_long_string(uint8_t *buf, int n, int *n_tokens) {
+    size_t len = append(buf, 0, "\"");
+    for (int i = 0; i < n; i++) {
+        len = append(buf, len, "a");
+    }
+    *n_tokens = 1;
+    return append(buf, len, "\"");
+}
+
+// -1111...1.1111...1e1111...1
+static size_t gen_long_number(uint8_t *buf, int n, int *n_tokens) {
+    size_t len = append(buf, 0, "-");
+    for (int i = 0; i < n; i++) {
+        len = append(buf, len, "1");
+    }
+    len = append(buf, len, ".");
+    for (int i = 0; i < n; i++) {
+        len = append(buf, len, "1");
+    }
+    len = append(buf, len, "e");
+    for (int i = 0; i < n; i++) {
+        len = append(buf, len, "1");
+    }
+    *n_tokens = 1;
+    return len;
+}
+
+/**
+ * @brief Return the best-of-N_TRIALS time, in seconds per byte, to parse the
+ * document generated with n elements reps times.
+ */
+static double time_per_byte(generator_t generator, int n, int reps) {
+    int n_tokens;
+    size_t len = generator(s_json, n, &n_tokens);
+    double best = 0.0;
+
+    TEST_ASSERT_TRUE(len <= sizeof(s_json));
+    for (int trial = 0; trial < N_TRIALS; trial++) {
+        clock_t start = clock();
+        for (int i = 0; i < reps; i++) {
+            TEST_ASSERT_EQUAL_INT(
+                n_tokens,
+                mu_json_parse_buffer(s_tokens, MAX_TOKENS, s_json, len, NULL));
+        }
+        double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+        if (trial == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best / ((double)len * reps);
+}
+
+/**
+ * @brief Assert that parsing a document SCALE times larger costs no more than
+ * MAX_RATIO times as much per byte.
+ */
+static void check_scaling(const char *name, generator_t generator, int n) {
+    char msg[100];
+    double small = time_per_byte(generator, n / SCALE, LARGE_REPS * SCALE);
+    double large = time_per_byte(generator, n, LARGE_REPS);
+    // guard against a zero-length timing on very fast machines
+    double ratio = small > 0.0 ? large / small : 1.0;
+
+    snprintf(msg, sizeof(msg), "%s: per-byte cost grew %.1fx for %dx input",
+             name, ratio, SCALE);
+    TEST_ASSERT_MESSAGE(ratio < MAX_RATIO, msg);
+}
+
+void test_wide_array(void) {
+    check_scaling("wide array", gen_wide_array, MAX_ELEMENTS);
+}
+
+void test_wide_object(void) {
+    check_scaling("wide object", gen_wide_object, MAX_ELEMENTS);
+}
+
+void test_wide_containers(void) {
+    check_scaling("wide containers", gen_wide_containers, MAX_ELEMENTS);
+}
+
+void test_deep_objects(void) {
+    check_scaling("deep objects", gen_deep_objects, MAX_DEPTH);
+}
+
+void test_deep_arrays(void) {
+    check_scaling("deep arrays", gen_deep_arrays, MAX_DEPTH);
+}
+
+void test_long_string(void) {
+    check_scaling("long string", gen_long_string, MAX_JSON_STRING / 2);
+}
+
+void test_long_number(void) {
+    check_scaling("long number", gen_long_number, MAX_JSON_STRING / 4);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_wide_array);
+    RUN_TEST(test_wide_object);
+    RUN_TEST(test_wide_containers);
+    RUN_TEST(test_deep_objects);
+    RUN_TEST(test_deep_arrays);
+    RUN_TEST(test_long_string);
+    RUN_TEST(test_long_number);
+
+    return UNITY_END();
+}
@@ -0,0 +1,114 @@
+/**
+ * @file gen_fused_table.c
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 R. D. Poor <rdpoor # gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Generate the fused byte-to-state transition table for mu_json.
+
+Usage:
+
+  gen_fused_table > ../src/mu_json_fused.h
+
+mu_json maps each input byte to a character class (ascii_classes[]), then maps
+the (state, class) pair to the next state (state_transition_table[]).  This
+tool folds the two into a single uint8_t[NR_STATES][256] table indexed by state
+and raw byte, which mu_json.c uses when built with MU_JSON_FUSED_TABLE.  The
+table is written to stdout; the memory used by each table variant is reported
+on stderr.
+
+The tables are static, so this file includes mu_json.c directly.
+*/
+
+// *****************************************************************************
+// Includes
+
+#include "../src/mu_json.c"
+
+#include <stdio.h>
+
+// *****************************************************************************
+// Private types and definitions
+
+#define BYTES_PER_LINE 16
+
+// *****************************************************************************
+// Private (forward) declarations
+
+static void emit_table(FILE *out);
+static void report_sizes(FILE *out);
+
+// *****************************************************************************
+// Public code
+
+int main(void) {
+    emit_table(stdout);
+    report_sizes(stderr);
+    return 0;
+}
+
+// *****************************************************************************
+// Private (static) code
+
+static void emit_table(FILE *out) {
+    fprintf(out,
+            "/**\n"
+            " * @file mu_json_fused.h\n"
+            " *\n"
+            " * Generated by tools/gen_fused_table -- do not edit.\n"
+            " *\n"
+            " * Maps (state, input byte) directly to the next state: the\n"
+            " * composition of ascii_classes[] and state_transition_table[]\n"
+            " * in mu_json.c, which includes this file when built with\n"
+            " * MU_JSON_FUSED_TABLE.\n"
+            " */\n\n");
+    fprintf(out, "// clang-format off\n");
+    fprintf(out, "static const uint8_t fused_transition_table[NR_STATES][256] "
+                 "= {\n");
+    for (int state = 0; state < NR_STATES; state++) {
+        fprintf(out, "/*%s*/ {\n", s_state_names[state]);
+        for (int ch = 0; ch < 256; ch++) {
+            int next_state = lookup_byte(state, (uint8_t)ch);
+            fprintf(out, "%s%s,%s", ch % BYTES_PER_LINE == 0 ? "    " : "",
+                    next_state == __ ? "__" : s_state_names[next_state],
+                    ch % BYTES_PER_LINE == BYTES_PER_LINE - 1 ? "\n" : "");
+        }
+        fprintf(out, "},\n");
+    }
+    fprintf(out, "};\n");
+    fprintf(out, "// clang-format on\n");
+}
+
+static void report_sizes(FILE *out) {
+    size_t classes = sizeof(ascii_classes);
+    size_t transitions = sizeof(state_transition_table);
+    size_t fused = NR_STATES * 256;
+
+    fprintf(out, "class tables (default): %zu + %zu = %zu bytes\n", classes,
+            transitions, classes + transitions);
+    fprintf(out, "  as int[] (before uint8_t): %zu bytes\n",
+            (classes + transitions) * sizeof(int));
+    fprintf(out, "fused table (MU_JSON_FUSED_TABLE): %d x 256 = %zu bytes\n",
+            NR_STATES, fused);
+}
@@ -0,0 +1,736 @@
+/**
+ * @file mu_json_cli.c
+ *
+ * MIT License
+ *
+ * Copyright (c) 2024 R. D. Poor <rdpoor # gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @brief Validate, reformat and query JSON files from the command line.
+
+Usage:
+
+  mu_json [-n] [-t] validate [file ...]
+  mu_json [-n] [-t] minify [file ...]
+  mu_json [-n] [-t] pretty [file ...]
+  mu_json [-n] [-t] count [file ...]
+  mu_json [-n] [-t] query POINTER [file ...]
+  mu_json [-n] [-t] filter PREDICATE [PREDICATE ...] -- [file ...]
+
+Each file (or stdin, if there are none or a file is `-`) holds one JSON
+document, or with -n one document per line (NDJSON); blank lines are skipped.
+
+  validate  print nothing; report each invalid document on stderr
+  minify    print each document without whitespace
+  pretty    print each document indented by two spaces
+  count     print the number of tokens in each document
+  query     print the value at an RFC 6901 JSON Pointer, e.g. /items/0/sku
+  filter    print each document that meets every PREDICATE, one of:
+              POINTER           the field exists
+              POINTER=JSON      the field's JSON text is JSON, e.g. /a="b"
+              POINTER=MIN..MAX  the field is a number in [MIN, MAX]
+
+The exit status is 0 if every document was valid (and, for query, had the
+value), 1 if not and 2 on a usage or I/O error.  -t reports the bytes and
+records processed (for filter -n, the records that matched) and the throughput
+on stderr, so that the tool can be used as an end-to-end benchmark.
+
+Regular files are mapped rather than read.  A single document must be shorter
+than 2 GiB, as must each line of an NDJSON file; NDJSON read from a pipe is
+processed a block at a time, so its total size is unlimited.  filter -n parses
+only the selected fields of each candidate line, and reports (rather than
+filters) a line in which they hold more than FILTER_TOKENS tokens.
+*/
+
+// *****************************************************************************
+// Includes
+
+#define _GNU_SOURCE // for memrchr()
+
+#include "mu_json.h"
+#include "mu_str.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// *****************************************************************************
+// Private types and definitions
+
+#define OUT_SIZE (1 << 20)     // output is written in blocks this large
+#define READ_SIZE (64 << 20)   // unmappable input is read this much at a time
+#define CHUNK_SIZE (1u << 30)  // a filter searches at most this much at once
+#define MIN_TOKENS 1024        // the token store starts this small, and grows
+#define FILTER_TOKENS 65536    // the filter's token store starts this large
+#define MAX_DOCUMENT INT_MAX   // mu_str's limit on a document's length
+
+typedef enum {
+    CMD_VALIDATE,
+    CMD_MINIFY,
+    CMD_PRETTY,
+    CMD_COUNT,
+    CMD_QUERY,
+    CMD_FILTER,
+} command_t;
+
+// *****************************************************************************
+// Private (static) storage
+
+static command_t s_command;
+static bool s_ndjson;
+static bool s_timing;
+static const char *s_name; // current input, for messages
+static size_t s_line;      // current line of NDJSON input
+static size_t s_bytes;     // input processed, for -t
+static size_t s_records;
+static bool s_failed; // a document was invalid, or lacked the queried value
+
+static mu_json_projection_t s_projection; // query: the pointer to parse
+static int s_n_segments;
+static mu_json_filter_predicate_t s_predicates[MU_JSON_PROJECT_MAX_POINTERS];
+static mu_json_filter_t s_filter;
+
+static mu_json_token_t *s_tokens;
+static size_t s_max_tokens;
+
+static uint8_t s_out[OUT_SIZE];
+static size_t s_out_len;
+
+// *****************************************************************************
+// Private (forward) declarations
+
+/**
+ * @brief Print usage on stderr and return the exit status for a usage error.
+ */
+static int usage(void);
+
+/**
+ * @brief Parse a filter predicate from the command line into `predicate`.
+ * Return false if it is malformed.
+ */
+static bool parse_predicate(char *arg, mu_json_filter_predicate_t *predicate);
+
+/**
+ * @brief Process one file, or stdin if `path` is "-".  Return false on an I/O
+ * error.
+ */
+static bool process_file(const char *path);
+
+/**
+ * @brief Process the whole of a mapped or read input.
+ */
+static void process_buffer(const uint8_t *buf, size_t buflen);
+
+/**
+ * @brief Process input that can't be mapped.  A single document is read
+ * whole, NDJSON a block of lines at a time.  Return false on an I/O error.
+ */
+static bool process_stream(int fd);
+
+/**
+ * @brief Process each complete line of `buf`, and the final, unterminated one
+ * too if `at_end`.  Return the number of bytes consumed.
+ */
+static size_t process_lines(const uint8_t *buf, size_t buflen, bool at_end);
+
+/**
+ * @brief Process one document.
+ */
+static void process_document(const uint8_t *buf, size_t buflen);
+
+/**
+ * @brief Parse a document into s_tokens, growing the store as needed.
+ */
+static int parse(const uint8_t *buf, size_t buflen, mu_json_parse_opts_t *opts);
+
+/**
+ * @brief Return true if a record meets the filter's predicates, growing the
+ * filter's token store as needed.
+ */
+static bool filter_match(const uint8_t *buf, size_t buflen);
+
+/**
+ * @brief Double s_tokens, unless it already holds a token for each byte of a
+ * `buflen`-byte document.  Return false if it was not grown.
+ */
+static bool grow_tokens(size_t buflen);
+
+/**
+ * @brief Return the value at the query's pointer in a projected parse, or
+ * NULL.
+ */
+static mu_json_token_t *resolve_query(mu_json_token_t *root);
+
+/**
+ * @brief Return true if a member's key equals a pointer segment.
+ */
+static bool key_matches(const mu_json_pointer_segment_t *segment,
+                        mu_json_token_t *key);
+
+/**
+ * @brief Write a parsed value, indented by two spaces per level.
+ */
+static void write_pretty(mu_json_token_t *token, int indent);
+
+/**
+ * @brief Write a record passed by the filter, with a newline.
+ */
+static bool write_record(mu_str_t *record, void *arg);
+
+/**
+ * @brief Report an invalid document on stderr.
+ */
+static void report(int err);
+
+static void write_bytes(const void *buf, size_t length);
+static void write_byte(uint8_t byte);
+static void write_indent(int indent);
+static bool flush_output(void);
+static double now_s(void);
+
+// *****************************************************************************
+// Public code
+
+int main(int argc, char **argv) {
+    int i = 1;
+
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        if (strcmp(argv[i], "-n") == 0) {
+            s_ndjson = true;
+        } else if (strcmp(argv[i], "-t") == 0) {
+            s_timing = true;
+        } else {
+            return usage();
+        }
+    }
+    if (i == argc) {
+        return usage();
+    }
+    const char *command = argv[i++];
+    if (strcmp(command, "validate") == 0) {
+        s_command = CMD_VALIDATE;
+    } else if (strcmp(command, "minify") == 0) {
+        s_command = CMD_MINIFY;
+    } else if (strcmp(command, "pretty") == 0) {
+        s_command = CMD_PRETTY;
+    } else if (strcmp(command, "count") == 0) {
+        s_command = CMD_COUNT;
+    } else if (strcmp(command, "query") == 0 && i < argc) {
+        const char *pointer = argv[i++];
+        s_command = CMD_QUERY;
+        if (mu_json_projection_init(&s_projection, &pointer, 1) !=
+            MU_JSON_ERR_NONE) {
+            fprintf(stderr, "mu_json: bad JSON Pointer '%s'\n", pointer);
+            return 2;
+        }
+        while (!(s_projection.complete[s_n_segments] & 1)) {
+            s_n_segments += 1;
+        }
+    } else if (strcmp(command, "filter") == 0) {
+        size_t n = 0;
+        s_command = CMD_FILTER;
+        for (; i < argc && strcmp(argv[i], "--") != 0; i++) {
+            // a copy, since the pointer is split from the value in place
+            if (n == MU_JSON_PROJECT_MAX_POINTERS ||
+                !parse_predicate(strdup(argv[i]), &s_predicates[n++])) {
+                fprintf(stderr, "mu_json: bad predicate '%s'\n", argv[i]);
+                return 2;
+            }
+        }
+        i += i < argc; // skip the "--"
+        s_tokens = malloc(FILTER_TOKENS * sizeof(mu_json_token_t));
+        s_max_tokens = FILTER_TOKENS;
+        if (n == 0 || s_tokens == NULL ||
+            mu_json_filter_init(&s_filter, s_predicates, n, s_tokens,
+                                s_max_tokens) != MU_JSON_ERR_NONE) {
+            return usage();
+        }
+    } else {
+        return usage();
+    }
+
+    bool ok = true;
+    double start = now_s();
+    if (i == argc) {
+        ok = process_file("-");
+    }
+    for (; i < argc && ok; i++) {
+        ok = process_file(argv[i]);
+    }
+    ok = flush_output() && ok;
+    if (s_timing) {
+        double elapsed = now_s() - start;
+        fprintf(stderr, "%zu bytes, %zu records in %.3f s (%.1f MB/s)\n",
+                s_bytes, s_records, elapsed,
+                elapsed > 0 ? s_bytes / elapsed / 1e6 : 0.0);
+    }
+    return !ok ? 2 : s_failed ? 1 : 0;
+}
+
+// *****************************************************************************
+// Private (static) code
+
+static int usage(void) {
+    fprintf(stderr,
+            "usage: mu_json [-n] [-t] validate|minify|pretty|count [file ...]\n"
+            "       mu_json [-n] [-t] query POINTER [file ...]\n"
+            "       mu_json [-n] [-t] filter PREDICATE ... -- [file ...]\n"
+            "  -n  each line is a document (NDJSON)\n"
+            "  -t  report throughput on stderr\n"
+            "  PREDICATE is POINTER, POINTER=JSON or POINTER=MIN..MAX\n");
+    return 2;
+}
+
+static bool parse_predicate(char *arg, mu_json_filter_predicate_t *predicate) {
+    char *value = arg ? strchr(arg, '=') : NULL;
+    char *range;
+
+    if (arg == NULL) {
+        return false;
+    }
+    predicate->pointer = arg;
+    predicate->op = MU_JSON_FILTER_EXISTS;
+    if (value == NULL) {
+        return true;
+    }
+    *value++ = '\0';
+    if (value[0] != '"' && (range = strstr(value, "..")) != NULL) {
+        char *end;
+        predicate->op = MU_JSON_FILTER_RANGE;
+        *range = '\0';
+        predicate->min = strtod(value, &end);
+        if (*end != '\0' || value == range) {
+            return false;
+        }
+        predicate->max = strtod(range + 2, &end);
+        return *end == '\0' && end != range + 2;
+    }
+    predicate->op = MU_JSON_FILTER_EQUALS;
+    predicate->value = value;
+    // the field's text is compared as written, so the value must be JSON too
+    return mu_json_validate((const uint8_t *)value, strlen(value)) ==
+           MU_JSON_ERR_NONE;
+}
+
+static bool process_file(const char *path) {
+    int fd = strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY);
+    struct stat st;
+    bool ok = true;
+
+    s_name = strcmp(path, "-") == 0 ? "<stdin>" : path;
+    s_line = 0;
+    if (fd < 0) {
+        fprintf(stderr, "mu_json: %s: %s\n", s_name, strerror(errno));
+        return false;
+    }
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        size_t size = (size_t)st.st_size;
+        void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, size, MADV_SEQUENTIAL);
+            process_buffer(map, size);
+            munmap(map, size);
+        } else {
+            ok = process_stream(fd);
+        }
+    } else {
+        ok = process_stream(fd);
+    }
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+    return ok;
+}
+
+static void process_buffer(const uint8_t *buf, size_t buflen) {
+    s_bytes += buflen;
+    if (!s_ndjson) {
+        process_document(buf, buflen);
+    } else if (s_command != CMD_FILTER || !s_filter.projected) {
+        // A filter that parses whole records may need more tokens for a line
+        // than it has, and must be retried line by line.
+        process_lines(buf, buflen, true);
+    } else {
+        // The filter skips from candidate to candidate itself, but can search
+        // only so far at once: hand it chunks that end at a newline.
+        while (buflen > 0) {
+            size_t length = buflen;
+            if (length > CHUNK_SIZE) {
+                const uint8_t *nl = memrchr(buf, '\n', CHUNK_SIZE);
+                if (nl == NULL) {
+                    // a line longer than a chunk gets a chunk of its own
+                    nl = memchr(&buf[CHUNK_SIZE], '\n', buflen - CHUNK_SIZE);
+                }
+                length = nl ? (size_t)(nl - buf) + 1 : buflen;
+            }
+            if (length < MAX_DOCUMENT) {
+                size_t no_tokens = s_filter.no_tokens;
+                s_records += mu_json_filter_ndjson(&s_filter, buf, length,
+                                                   write_record, NULL);
+                if (s_filter.no_tokens > no_tokens) {
+                    // rare: a selected field is a container of 64K tokens
+                    fprintf(stderr, "mu_json: %s: records too large to "
+                            "filter: %zu\n", s_name,
+                            s_filter.no_tokens - no_tokens);
+                    s_failed = true;
+                }
+            } else {
+                report(MU_JSON_ERR_LIMIT); // one line, too long to filter
+            }
+            buf += length;
+            buflen -= length;
+        }
+    }
+}
+
+static bool process_stream(int fd) {
+    size_t size = READ_SIZE;
+    size_t length = 0;
+    uint8_t *buf = malloc(size);
+    bool ok = buf != NULL;
+
+    while (ok) {
+        if (length == size) {
+            // a single document, or a line longer than the buffer
+            uint8_t *bigger = realloc(buf, size * 2);
+            if (bigger == NULL) {
+                fprintf(stderr, "mu_json: %s: out of memory\n", s_name);
+                ok = false;
+                break;
+            }
+            buf = bigger;
+            size *= 2;
+        }
+        ssize_t n = read(fd, &buf[length], size - length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0) {
+            fprintf(stderr, "mu_json: %s: %s\n", s_name, strerror(errno));
+            ok = false;
+        } else if (n == 0) {
+            break;
+        } else if (s_ndjson) {
+            length += n;
+            const uint8_t *nl = memrchr(buf, '\n', length);
+            if (nl != NULL) {
+                size_t lines = (size_t)(nl - buf) + 1;
+                process_buffer(buf, lines);
+                memmove(buf, &buf[lines], length - lines);
+                length -= lines;
+            }
+        } else {
+            length += n;
+        }
+    }
+    if (ok) {
+        process_buffer(buf, length);
+    }
+    free(buf);
+    return ok;
+}
+
+static size_t process_lines(const uint8_t *buf, size_t buflen, bool at_end) {
+    size_t from = 0;
+
+    while (from < buflen) {
+        const uint8_t *nl = memchr(&buf[from], '\n', buflen - from);
+        if (nl == NULL && !at_end) {
+            break;
+        }
+        size_t end = nl ? (size_t)(nl - buf) : buflen;
+        size_t length = end - from;
+        s_line += 1;
+        if (length > 0 && buf[end - 1] == '\r') {
+            length -= 1;
+        }
+        if (length > 0) {
+            process_document(&buf[from], length);
+        }
+        from = nl ? end + 1 : buflen;
+    }
+    return from;
+}
+
+static void process_document(const uint8_t *buf, size_t buflen) {
+    mu_json_parse_opts_t opts = {0};
+    int n;
+
+    s_records += 1;
+    if (buflen >= MAX_DOCUMENT) {
+        report(MU_JSON_ERR_LIMIT);
+        return;
+    }
+    switch (s_command) {
+    case CMD_VALIDATE:
+        if ((n = mu_json_validate(buf, buflen)) != MU_JSON_ERR_NONE) {
+            report(n);
+        }
+        break;
+    case CMD_MINIFY:
+        if ((n = parse(buf, buflen, NULL)) < 0) {
+            report(n);
+        } else {
+            int size = mu_json_compact_copy(s_tokens, n, NULL, 0);
+            if ((size_t)size + 1 > OUT_SIZE - s_out_len) {
+                flush_output();
+            }
+            if ((size_t)size + 1 <= OUT_SIZE) {
+                // minify straight into the output buffer
+                s_out_len += mu_json_compact_copy(s_tokens, n,
+                                                  &s_out[s_out_len], size);
+            } else {
+                uint8_t *copy = malloc(size);
+                if (copy == NULL) {
+                    report(MU_JSON_ERR_LIMIT);
+                    break;
+                }
+                write_bytes(copy, mu_json_compact_copy(s_tokens, n, copy,
+                                                       size));
+                free(copy);
+            }
+            write_byte('\n');
+        }
+        break;
+    case CMD_PRETTY:
+        if ((n = parse(buf, buflen, NULL)) < 0) {
+            report(n);
+        } else {
+            write_pretty(s_tokens, 0);
+            write_byte('\n');
+        }
+        break;
+    case CMD_COUNT:
+        if ((n = parse(buf, buflen, NULL)) < 0) {
+            report(n);
+        } else {
+            char text[16];
+            write_bytes(text, snprintf(text, sizeof(text), "%d\n", n));
+        }
+        break;
+    case CMD_QUERY:
+        opts.projection = &s_projection;
+        if ((n = parse(buf, buflen, &opts)) < 0) {
+            report(n);
+        } else {
+            mu_json_token_t *value = resolve_query(s_tokens);
+            if (value == NULL) {
+                s_failed = true;
+            } else {
+                write_bytes(mu_str_buf(&value->json),
+                            mu_str_length(&value->json));
+                write_byte('\n');
+            }
+        }
+        break;
+    case CMD_FILTER:
+        if (filter_match(buf, buflen)) {
+            write_bytes(buf, buflen);
+            write_byte('\n');
+        }
+        break;
+    }
+}
+
+static int parse(const uint8_t *buf, size_t buflen,
+                 mu_json_parse_opts_t *opts) {
+    while (true) {
+        int n = mu_json_parse_buffer(s_tokens, s_max_tokens, buf, buflen, opts);
+        if (n != MU_JSON_ERR_NO_TOKENS || !grow_tokens(buflen)) {
+            return n;
+        }
+    }
+}
+
+static bool filter_match(const uint8_t *buf, size_t buflen) {
+    while (true) {
+        size_t no_tokens = s_filter.no_tokens;
+        if (mu_json_filter_match(&s_filter, buf, buflen)) {
+            return true;
+        } else if (s_filter.no_tokens == no_tokens) {
+            return false;
+        } else if (!grow_tokens(buflen)) {
+            report(MU_JSON_ERR_NO_TOKENS);
+            return false;
+        }
+        mu_json_filter_init(&s_filter, s_filter.predicates,
+                            s_filter.n_predicates, s_tokens, s_max_tokens);
+    }
+}
+
+static bool grow_tokens(size_t buflen) {
+    // every token takes at least one byte of input
+    if (s_max_tokens > buflen) {
+        return false;
+    }
+    size_t max_tokens = s_max_tokens ? s_max_tokens * 2 : MIN_TOKENS;
+    mu_json_token_t *tokens =
+        realloc(s_tokens, max_tokens * sizeof(mu_json_token_t));
+    if (tokens == NULL) {
+        return false;
+    }
+    s_tokens = tokens;
+    s_max_tokens = max_tokens;
+    return true;
+}
+
+static mu_json_token_t *resolve_query(mu_json_token_t *root) {
+    mu_json_token_t *t = root;
+
+    for (int i = 0; i < s_n_segments && t != NULL; i++) {
+        const mu_json_pointer_segment_t *segment = &s_projection.segments[i][0];
+        if (mu_json_token_type(t) == MU_JSON_TOKEN_TYPE_OBJECT) {
+            mu_json_token_t *key = mu_json_token_child(t);
+            while (key != NULL && !key_matches(segment, key)) {
+                key = mu_json_token_next_sibling(key + 1);
+            }
+            t = key ? key + 1 : NULL;
+        } else if (mu_json_token_type(t) == MU_JSON_TOKEN_TYPE_ARRAY &&
+                   segment->index >= 0) {
+            // the projection kept only the one element, if there was one
+            t = mu_json_token_child(t);
+        } else {
+            t = NULL;
+        }
+    }
+    return t;
+}
+
+static bool key_matches(const mu_json_pointer_segment_t *segment,
+                        mu_json_token_t *key) {
+    const uint8_t *text = mu_str_buf(&key->json) + 1; // skip the quotes
+    size_t length = mu_str_length(&key->json) - 2;
+    size_t j = 0;
+
+    for (size_t i = 0; i < segment->length; i++, j++) {
+        char c = segment->key[i];
+        if (c == '~' && i + 1 < segment->length) {
+            c = segment->key[++i] == '0' ? '~' : '/';
+        }
+        if (j == length || text[j] != (uint8_t)c) {
+            return false;
+        }
+    }
+    return j == length;
+}
+
+static void write_pretty(mu_json_token_t *token, int indent) {
+    mu_json_token_type_t type = mu_json_token_type(token);
+    mu_json_token_t *child = mu_json_token_child(token);
+
+    if (type != MU_JSON_TOKEN_TYPE_ARRAY && type != MU_JSON_TOKEN_TYPE_OBJECT) {
+        write_bytes(mu_str_buf(&token->json), mu_str_length(&token->json));
+        return;
+    }
+    write_byte(type == MU_JSON_TOKEN_TYPE_ARRAY ? '[' : '{');
+    for (mu_json_token_t *t = child; t != NULL;
+         t = mu_json_token_next_sibling(t)) {
+        write_byte('\n');
+        write_indent(indent + 1);
+        if (type == MU_JSON_TOKEN_TYPE_OBJECT) {
+            write_bytes(mu_str_buf(&t->json), mu_str_length(&t->json));
+            write_bytes(": ", 2);
+            t += 1; // the member's value
+        }
+        write_pretty(t, indent + 1);
+        if (mu_json_token_next_sibling(t) != NULL) {
+            write_byte(',');
+        }
+    }
+    if (child != NULL) {
+        write_byte('\n');
+        write_indent(indent);
+    }
+    write_byte(type == MU_JSON_TOKEN_TYPE_ARRAY ? ']' : '}');
+}
+
+static bool write_record(mu_str_t *record, void *arg) {
+    (void)arg;
+    write_bytes(mu_str_buf(record), mu_str_length(record));
+    write_byte('\n');
+    return true;
+}
+
+static void report(int err) {
+    static const char *const messages[] = {
+        "ok", "bad format", "too many tokens", "incomplete", "too large",
+    };
+    const char *message = err <= 0 && -err < 5 ? messages[-err] : "error";
+
+    s_failed = true;
+    if (s_ndjson && s_line > 0) {
+        fprintf(stderr, "mu_json: %s:%zu: %s\n", s_name, s_line, message);
+    } else {
+        fprintf(stderr, "mu_json: %s: %s\n", s_name, message);
+    }
+}
+
+static void write_bytes(const void *buf, size_t length) {
+    if (length > OUT_SIZE - s_out_len) {
+        flush_output();
+        if (length > OUT_SIZE) {
+            fwrite(buf, 1, length, stdout);
+            return;
+        }
+    }
+    memcpy(&s_out[s_out_len], buf, length);
+    s_out_len += length;
+}
+
+static void write_byte(uint8_t byte) {
+    if (s_out_len == OUT_SIZE) {
+        flush_output();
+    }
+    s_out[s_out_len++] = byte;
+}
+
+static void write_indent(int indent) {
+    static const char spaces[] = "                                ";
+
+    for (size_t n = 2 * (size_t)indent; n > 0;) {
+        size_t chunk = n < sizeof(spaces) - 1 ? n : sizeof(spaces) - 1;
+        write_bytes(spaces, chunk);
+        n -= chunk;
+    }
+}
+
+static bool flush_output(void) {
+    if (s_out_len > 0) {
+        fwrite(s_out, 1, s_out_len, stdout);
+        s_out_len = 0;
+    }
+    return fflush(stdout) == 0 && !ferror(stdout);
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}